@@ -1,8 +1,10 @@
-from fastapi import FastAPI
+from fastapi import FastAPI, Response
 from pydantic import BaseModel
 from sentence_transformers import SentenceTransformer
 from typing import List
+import numpy as np
 import os
+import struct
 import sys
 
 # Model name and cache directory
@@ -15,6 +17,9 @@ class EmbeddingRequest(BaseModel):
     texts: List[str]
     ids: List[str]
 
+class BinaryEmbeddingRequest(EmbeddingRequest):
+    dtype: str = "float32"  # or "fp16"
+
 class EmbeddingResponse(BaseModel):
     id: str
     embedding: List[float]
@@ -22,4 +27,23 @@ class EmbeddingResponse(BaseModel):
 @app.post("/embed", response_model=List[EmbeddingResponse])
 def embed(req: EmbeddingRequest):
     embeddings = model.encode(req.texts, show_progress_bar=False)
-    return [{"id": id_, "embedding": emb.tolist()} for id_, emb in zip(req.ids, embeddings)] 
\ No newline at end of file
+    return [{"id": id_, "embedding": emb.tolist()} for id_, emb in zip(req.ids, embeddings)]
+
+# Same embeddings as /embed as one little-endian matrix, so the client copies
+# rows instead of parsing floats. Layout (see EmbeddingClient.cpp):
+#   "MEMB", uint16 version, uint16 dtype (0 = float32, 1 = fp16),
+#   uint32 rows, uint32 dim, uint32 id_bytes, uint32 reserved,
+#   uint32 id lengths[rows], id bytes padded to 4, then the matrix
+@app.post("/embed/binary")
+def embed_binary(req: BinaryEmbeddingRequest):
+    fp16 = req.dtype == "fp16"
+    embeddings = model.encode(req.texts, show_progress_bar=False)
+    matrix = np.ascontiguousarray(embeddings, dtype="<f2" if fp16 else "<f4")
+    ids = [id_.encode("utf-8") for id_ in req.ids]
+    id_bytes = b"".join(ids)
+    rows, dim = matrix.shape
+    header = struct.pack("<4sHHIIII", b"MEMB", 1, 1 if fp16 else 0, rows, dim, len(id_bytes), 0)
+    lengths = struct.pack("<%dI" % rows, *[len(id_) for id_ in ids])
+    padding = b"\0" * (-(len(header) + len(lengths) + len(id_bytes)) % 4)
+    body = header + lengths + id_bytes + padding + matrix.tobytes()
+    return Response(content=body, media_type="application/octet-stream")
@@ -53,6 +53,18 @@ echo -e "invalid_command\nquit" | run_with_timeout 5 ./mimir > /dev/null
 echo "🔍 Testing edge cases..."
 echo -e "\n\n\nhelp\nquit" | run_with_timeout 5 ./mimir > /dev/null
 
+# Test 5: Text clean-up matches the regex version it replaced
+bash scripts/test_text_normalizer.sh
+
+# Test 6: Vector indexes against exact search, and their index files
+bash scripts/test_vector_db.sh
+
+# Test 7: Document embedding cache under compaction and concurrent writers
+bash scripts/test_embedding_cache.sh
+
+# Test 8: Embedding retries, partial results and the circuit breaker
+bash scripts/test_embedding_client.sh
+
 # Verify binary exists and is executable
 if [ -f "./mimir" ] && [ -x "./mimir" ]; then
     echo "✅ Binary is properly built and executable"
@@ -131,4 +143,24 @@ fi
 rm -f test_hybrid_doc.txt hybrid_test.log
 rm -rf .data/ 2>/dev/null || true
 
+# Check add-doc, query and load end to end on the mock embedding backend,
+# which needs no server
+echo "📁 Testing documents and queries with the mock embedding backend..."
+MIMIR_BIN="$(pwd)/mimir"
+MOCK_DIR=$(mktemp -d)
+sed 's/^  backend: server/  backend: mock/' config.yaml > "$MOCK_DIR/config.yaml"
+cp README.md "$MOCK_DIR/mock_doc.md"
+(cd "$MOCK_DIR" && echo -e "init mock_test\nadd-doc mock_doc.md\nquery how do I build\nclose\nload mock_test\nadd-doc mock_doc.md\nreindex\nquit" | run_with_timeout 30 "$MIMIR_BIN") > mock_test.log 2>&1
+
+for expected in "processed into" "already added to session" "Every chunk is already in the index"; do
+    if ! grep -q "$expected" mock_test.log; then
+        echo "❌ Mock backend run did not report: $expected"
+        cat mock_test.log
+        rm -rf "$MOCK_DIR" mock_test.log
+        exit 1
+    fi
+done
+echo "✅ Documents embed, reload and reindex with the mock backend"
+rm -rf "$MOCK_DIR" mock_test.log
+
 echo "✅ All CI tests passed!"
\ No newline at end of file
@@ -0,0 +1,170 @@
+#!/bin/bash
+set -e
+
+echo "🧪 Testing the document embedding cache: compaction and concurrent writers..."
+
+# Ensure we're in the right directory
+if [ ! -f "Makefile" ]; then
+    echo "❌ Makefile not found. Are you in the project root?"
+    exit 1
+fi
+
+BUILD_DIR=$(mktemp -d)
+trap 'rm -rf "$BUILD_DIR"' EXIT
+
+cat > "$BUILD_DIR/embedding_cache_check.cpp" <<'EOF'
+#include "EmbeddingDiskCache.h"
+#include <iostream>
+#include <string>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+static const int DIM = 64;
+static const uint64_t RECORD_BYTES = 24 + DIM * sizeof(float);
+static const uint64_t HEADER_BYTES = 16;
+static int failures = 0;
+
+static void expect(bool condition, const string& what) {
+    if (!condition) {
+        cout << "❌ " << what << "\n";
+        ++failures;
+    }
+}
+
+// Each text's vector is derived from its number, so any record read back
+// can be checked
+static vector<float> vectorFor(int n) {
+    vector<float> vec(DIM);
+    for (int d = 0; d < DIM; ++d) vec[d] = float(n) + d / 100.0f;
+    return vec;
+}
+
+static void putRange(EmbeddingDiskCache& cache, int first, int last) {
+    for (int n = first; n < last; ++n) {
+        vector<float> vec = vectorFor(n);
+        cache.put(cache.keyFor("text " + to_string(n)), vec.data(), vec.size());
+    }
+}
+
+// 1 = present and intact, 0 = absent, -1 = present but wrong. The first
+// lookup also opens the file, which size() needs
+static int lookup(EmbeddingDiskCache& cache, int n) {
+    vector<float> out;
+    if (!cache.get(cache.keyFor("text " + to_string(n)), out)) return 0;
+    return out == vectorFor(n) ? 1 : -1;
+}
+
+static uint64_t fileSize(const string& dir) {
+    struct stat info;
+    return stat((dir + "/embedding_cache.bin").c_str(), &info) == 0 ? uint64_t(info.st_size) : 0;
+}
+
+// Whole records only, and every one of them readable and correct
+static void checkFile(const string& dir, uint64_t maxBytes, int first, int last, const string& what) {
+    EmbeddingDiskCache cache(dir, "model", DIM, maxBytes);
+    int present = 0;
+    for (int n = first; n < last; ++n) {
+        int state = lookup(cache, n);
+        expect(state >= 0, what + ": text " + to_string(n) + " read back wrong");
+        present += state > 0;
+    }
+    uint64_t size = fileSize(dir);
+    expect((size - HEADER_BYTES) % RECORD_BYTES == 0, what + ": file holds a partial record");
+    expect(cache.size() == (size - HEADER_BYTES) / RECORD_BYTES, what + ": records not all indexed");
+    expect(size_t(present) <= cache.size(), what + ": more hits than records");
+}
+
+static void runWriters(const string& dir, uint64_t maxBytes, int writers, int perWriter) {
+    vector<pid_t> children;
+    for (int w = 0; w < writers; ++w) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            EmbeddingDiskCache cache(dir, "model", DIM, maxBytes);
+            // Reopen halfway so compaction can run while others append
+            putRange(cache, w * perWriter, w * perWriter + perWriter / 2);
+            EmbeddingDiskCache reopened(dir, "model", DIM, maxBytes);
+            putRange(reopened, w * perWriter + perWriter / 2, (w + 1) * perWriter);
+            _exit(0);
+        }
+        children.push_back(pid);
+    }
+    for (pid_t pid : children) {
+        int status = 0;
+        waitpid(pid, &status, 0);
+        expect(WIFEXITED(status) && WEXITSTATUS(status) == 0, "a writer process failed");
+    }
+}
+
+int main(int argc, char** argv) {
+    string base = argc > 1 ? argv[1] : ".";
+
+    // Round trip, other models, and a torn tail from a crashed writer
+    string dir = base + "/round_trip";
+    {
+        EmbeddingDiskCache cache(dir, "model", DIM);
+        putRange(cache, 0, 100);
+    }
+    {
+        int fd = open((dir + "/embedding_cache.bin").c_str(), O_WRONLY | O_APPEND);
+        expect(fd >= 0 && write(fd, "torn", 4) == 4, "could not append a torn record");
+        close(fd);
+        EmbeddingDiskCache cache(dir, "model", DIM);
+        expect(lookup(cache, 0) == 1 && lookup(cache, 99) == 1, "records wrong after reopen");
+        expect(cache.size() == 100, "records lost or torn tail kept on reopen");
+        expect(fileSize(dir) == HEADER_BYTES + 100 * RECORD_BYTES, "torn tail not cut off");
+        EmbeddingDiskCache otherModel(dir, "other", DIM);
+        expect(lookup(otherModel, 0) == 0, "another model's text hit");
+    }
+    cout << "✅ Round trip and torn tail\n";
+
+    // Compaction keeps the newest records within half the cap
+    dir = base + "/compaction";
+    uint64_t cap = 200 * RECORD_BYTES;
+    {
+        EmbeddingDiskCache cache(dir, "model", DIM, cap);
+        putRange(cache, 0, 500);
+    }
+    {
+        EmbeddingDiskCache cache(dir, "model", DIM, cap);
+        expect(lookup(cache, 499) == 1, "newest record lost in compaction");
+        expect(lookup(cache, 0) == 0, "oldest record kept by compaction");
+        expect(fileSize(dir) <= cap / 2 + HEADER_BYTES, "compacted file over half the cap");
+        putRange(cache, 500, 510);
+        expect(lookup(cache, 505) == 1, "append after compaction lost");
+    }
+    checkFile(dir, cap, 0, 510, "compaction");
+    cout << "✅ Compaction\n";
+
+    // Writers in separate processes share one file
+    dir = base + "/writers";
+    runWriters(dir, 0, 6, 200);
+    {
+        EmbeddingDiskCache cache(dir, "model", DIM);
+        expect(lookup(cache, 0) == 1, "first writer's record lost");
+        expect(cache.size() == 6 * 200, "concurrent writers lost records: " + to_string(cache.size()));
+    }
+    checkFile(dir, 0, 0, 6 * 200, "concurrent writers");
+    cout << "✅ Concurrent writers\n";
+
+    // And while their opens compact it under them
+    dir = base + "/writers_compacting";
+    runWriters(dir, 150 * RECORD_BYTES, 6, 200);
+    checkFile(dir, 150 * RECORD_BYTES, 0, 6 * 200, "writers during compaction");
+    cout << "✅ Concurrent writers during compaction\n";
+
+    if (failures > 0) {
+        cout << "❌ " << failures << " embedding cache checks failed\n";
+        return 1;
+    }
+    cout << "✅ Embedding cache keeps whole, correct records\n";
+    return 0;
+}
+EOF
+
+${CXX:-g++} -std=c++17 -O2 -pthread -I./src/embedding \
+    "$BUILD_DIR/embedding_cache_check.cpp" src/embedding/EmbeddingDiskCache.cpp \
+    -o "$BUILD_DIR/embedding_cache_check"
+
+"$BUILD_DIR/embedding_cache_check" "$BUILD_DIR"
@@ -0,0 +1,172 @@
+#!/bin/bash
+set -e
+
+echo "🧪 Testing embedding retries, partial results and the circuit breaker..."
+
+# Ensure we're in the right directory
+if [ ! -f "Makefile" ]; then
+    echo "❌ Makefile not found. Are you in the project root?"
+    exit 1
+fi
+
+BUILD_DIR=$(mktemp -d)
+trap 'rm -rf "$BUILD_DIR"' EXIT
+
+# The client talks to an in-process stand-in for embedding_server.py whose
+# failures the test scripts
+cat > "$BUILD_DIR/embedding_client_check.cpp" <<'EOF'
+#include "EmbeddingClient.h"
+#include "httplib.h"
+#include <nlohmann/json.hpp>
+#include <iostream>
+#include <thread>
+#include <atomic>
+#include <chrono>
+
+static const size_t DIM = 8;
+static int failures = 0;
+
+static void expect(bool condition, const string& what) {
+    if (!condition) {
+        cout << "❌ " << what << "\n";
+        ++failures;
+    }
+}
+
+static vector<float> vectorFor(const string& text) {
+    vector<float> vec(DIM);
+    for (size_t d = 0; d < DIM; ++d) vec[d] = float(text.size() * 10 + d);
+    return vec;
+}
+
+// Answers /embed like the real server, except that batches containing
+// failText get a 503 while failCount lasts
+struct StandInServer {
+    httplib::Server server;
+    thread worker;
+    int port = 0;
+    atomic<int> requests{0};
+    atomic<int> failCount{0};
+    string failText;
+
+    StandInServer() {
+        server.Post("/embed", [this](const httplib::Request& req, httplib::Response& res) {
+            ++requests;
+            nlohmann::json body = nlohmann::json::parse(req.body);
+            vector<string> texts = body["texts"];
+            vector<string> ids = body["ids"];
+            for (const string& text : texts) {
+                if (text == failText && failCount > 0) {
+                    --failCount;
+                    res.status = 503;
+                    return;
+                }
+            }
+            nlohmann::json out = nlohmann::json::array();
+            for (size_t i = 0; i < texts.size(); ++i) {
+                out.push_back({{"id", ids[i]}, {"embedding", vectorFor(texts[i])}});
+            }
+            res.set_content(out.dump(), "application/json");
+        });
+        port = server.bind_to_any_port("127.0.0.1");
+        worker = thread([this]() { server.listen_after_bind(); });
+        server.wait_until_ready();
+    }
+
+    ~StandInServer() {
+        server.stop();
+        worker.join();
+    }
+};
+
+static bool embed(EmbeddingClient& client, const vector<string>& texts, vector<float>& out, size_t* cached) {
+    vector<string_view> views(texts.begin(), texts.end());
+    vector<string> ids;
+    for (size_t i = 0; i < texts.size(); ++i) ids.push_back("chunk_" + to_string(i));
+    size_t dim = 0;
+    bool ok = client.embedDocuments(views, ids, out, dim, cached);
+    if (ok) {
+        expect(dim == DIM && out.size() == texts.size() * DIM, "embeddings have the wrong shape");
+        for (size_t i = 0; ok && i < texts.size(); ++i) {
+            vector<float> row(out.begin() + i * DIM, out.begin() + (i + 1) * DIM);
+            expect(row == vectorFor(texts[i]), "row " + to_string(i) + " is not its text's embedding");
+        }
+    }
+    return ok;
+}
+
+static vector<string> makeTexts(const string& prefix, size_t count) {
+    vector<string> texts;
+    for (size_t i = 0; i < count; ++i) texts.push_back(prefix + string(i + 1, 'x'));
+    return texts;
+}
+
+int main(int argc, char** argv) {
+    StandInServer standIn;
+
+    EmbeddingConfig config;
+    config.backend = "server";
+    config.endpoint = "http://127.0.0.1:" + to_string(standIn.port);
+    config.dim = DIM;
+    config.batch_size = 4;
+    config.max_in_flight = 1;   // Batches go out in order, so which ones fail is fixed
+    config.max_retries = 2;
+    config.retry_backoff_ms = 1;
+    config.breaker_failures = 3;
+    config.breaker_cooldown_seconds = 1;
+    PerformanceConfig performance;
+    PathsConfig paths;
+    paths.temp_dir = argc > 1 ? argv[1] : ".";
+    EmbeddingClient client(config, performance, paths);
+    vector<float> out;
+    size_t cached = 0;
+
+    // One failed attempt on the second batch is retried and the call succeeds
+    vector<string> texts = makeTexts("retry ", 12);
+    standIn.failText = texts[5];
+    standIn.failCount = 1;
+    expect(embed(client, texts, out, &cached), "a batch that failed once was not retried");
+    expect(standIn.requests == 4, "expected 3 batches and 1 retry, server saw " + to_string(standIn.requests));
+    cout << "✅ Transient failure retried\n";
+
+    // The second batch fails every attempt: the first batch is kept in the
+    // document cache and three failures in a row open the breaker
+    texts = makeTexts("partial ", 12);
+    standIn.requests = 0;
+    standIn.failText = texts[5];
+    standIn.failCount = 1000;
+    expect(!embed(client, texts, out, &cached), "a batch failing every attempt succeeded");
+    expect(standIn.requests == 1 + 1 + config.max_retries,
+           "expected 1 batch and 3 attempts, server saw " + to_string(standIn.requests));
+
+    // While the breaker is open nothing is sent
+    standIn.requests = 0;
+    expect(!embed(client, texts, out, &cached), "succeeded with the breaker open");
+    expect(standIn.requests == 0, "sent " + to_string(standIn.requests) + " requests with the breaker open");
+    cout << "✅ Breaker opened after " << config.breaker_failures << " failures in a row\n";
+
+    // After the cooldown the server is tried again, and only the texts the
+    // failed call did not get are sent
+    this_thread::sleep_for(chrono::milliseconds(1100));
+    standIn.failCount = 0;
+    expect(embed(client, texts, out, &cached), "no recovery after the cooldown");
+    expect(cached == 4, "expected the first batch from the cache, got " + to_string(cached));
+    expect(standIn.requests == 2, "expected 2 batches after recovery, server saw " + to_string(standIn.requests));
+    cout << "✅ Recovered after the cooldown, reusing the batch that succeeded\n";
+
+    if (failures > 0) {
+        cout << "❌ " << failures << " embedding client checks failed\n";
+        return 1;
+    }
+    cout << "✅ Embedding client retries, keeps partial results and fails fast\n";
+    return 0;
+}
+EOF
+
+${CXX:-g++} -std=c++17 -O2 -pthread -I./include -I./src/embedding $CPPFLAGS \
+    "$BUILD_DIR/embedding_client_check.cpp" src/embedding/EmbeddingClient.cpp \
+    src/embedding/EmbeddingDiskCache.cpp src/embedding/QueryEmbeddingCache.cpp \
+    src/vector_db/DistanceKernels.cpp \
+    -o "$BUILD_DIR/embedding_client_check"
+
+"$BUILD_DIR/embedding_client_check" "$BUILD_DIR"
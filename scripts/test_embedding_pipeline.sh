@@ -47,16 +47,28 @@ if [ ! -f "$SESSION_DIR/metadata.json" ]; then
   exit 1
 fi
 
-# 5. Parse doc_chunks.json to verify embeddings
-EMBEDDING_COUNT=$(jq '[.chunks[] | select(.embedding != null and (.embedding | length) > 0)] | length' "$SESSION_DIR/doc_chunks.json")
+# 5. Parse doc_chunks.json to verify every chunk points at an embedding row
+EMBEDDING_COUNT=$(jq '[.chunks[] | select(.embedding_row != null and .embedding_row >= 0)] | length' "$SESSION_DIR/doc_chunks.json")
 CHUNK_COUNT=$(jq '.chunks | length' "$SESSION_DIR/doc_chunks.json")
-if [ "$EMBEDDING_COUNT" -eq "$CHUNK_COUNT" ]; then
-  echo "✅ All $CHUNK_COUNT chunks have non-empty embeddings."
-else
+if [ "$EMBEDDING_COUNT" -ne "$CHUNK_COUNT" ]; then
   echo "❌ Only $EMBEDDING_COUNT of $CHUNK_COUNT chunks have embeddings!"
   exit 1
 fi
 
+# faiss_index.bin: 64-byte header with dim at byte 20 and the row count at byte 24
+INDEX_FILE="$SESSION_DIR/faiss_index.bin"
+if [ ! -f "$INDEX_FILE" ]; then
+  echo "❌ faiss_index.bin not found in $SESSION_DIR"
+  exit 1
+fi
+INDEX_DIM=$(od -An -t u4 -j 20 -N 4 "$INDEX_FILE" | tr -d ' ')
+INDEX_ROWS=$(od -An -t u8 -j 24 -N 8 "$INDEX_FILE" | tr -d ' ')
+if [ "$INDEX_ROWS" -ne "$CHUNK_COUNT" ] || [ "$INDEX_DIM" -le 0 ]; then
+  echo "❌ faiss_index.bin holds $INDEX_ROWS rows for $CHUNK_COUNT chunks!"
+  exit 1
+fi
+echo "✅ All $CHUNK_COUNT chunks have non-empty embeddings ($INDEX_DIM dims each)."
+
 # 6. Print summary and timing benchmarks
 echo "[PASS] Embedding pipeline integration test succeeded."
 echo "--- Benchmark Results ---"
@@ -0,0 +1,109 @@
+#!/bin/bash
+set -e
+
+echo "🧪 Testing text normalizer against the regex clean-up it replaced..."
+
+# Ensure we're in the right directory
+if [ ! -f "Makefile" ]; then
+    echo "❌ Makefile not found. Are you in the project root?"
+    exit 1
+fi
+
+BUILD_DIR=$(mktemp -d)
+trap 'rm -rf "$BUILD_DIR"' EXIT
+
+# The reference functions are DocumentProcessor::cleanText and cleanPdfText
+# as they were written with std::regex
+cat > "$BUILD_DIR/normalizer_equivalence.cpp" <<'EOF'
+#include "TextNormalizer.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <random>
+#include <vector>
+#include <regex>
+
+static string regexCleanText(const string& text, bool removeExtraWhitespace) {
+    string cleaned = text;
+    if (removeExtraWhitespace) {
+        cleaned = regex_replace(cleaned, regex("  +"), " ");
+        cleaned = regex_replace(cleaned, regex("\n\n\n+"), "\n\n");
+        cleaned = regex_replace(cleaned, regex("\r"), "");
+    }
+    size_t start = cleaned.find_first_not_of(" \t\n");
+    if (start == string::npos) return "";
+    size_t end = cleaned.find_last_not_of(" \t\n");
+    return cleaned.substr(start, end - start + 1);
+}
+
+static string regexCleanPdfText(const string& text) {
+    string cleaned = text;
+    cleaned = regex_replace(cleaned, regex("-\\s*\\n\\s*"), "");
+    cleaned = regex_replace(cleaned, regex("  +"), " ");
+    cleaned = regex_replace(cleaned, regex("\\n\\s*\\d+\\s*\\n"), "\n\n");
+    cleaned = regex_replace(cleaned, regex("([.!?])\\s*\\n\\s*([a-z])"), "$1 $2");
+    cleaned = regex_replace(cleaned, regex("[\\x00-\\x08\\x0B\\x0C\\x0E-\\x1F\\x7F]"), "");
+    cleaned = regex_replace(cleaned, regex("\\n\\n\\n+"), "\n\n");
+    cleaned = regex_replace(cleaned, regex("^\\s+|\\s+$"), "");
+    return cleaned;
+}
+
+static int failures = 0;
+
+static void check(const string& name, const string& input) {
+    if (normalizeText(input, true) != regexCleanText(input, true) ||
+        normalizeText(input, false) != regexCleanText(input, false)) {
+        cout << "❌ cleanText differs on " << name << "\n";
+        ++failures;
+    }
+    if (normalizePdfText(input) != regexCleanPdfText(input)) {
+        cout << "❌ cleanPdfText differs on " << name << "\n";
+        ++failures;
+    }
+}
+
+int main(int argc, char** argv) {
+    const vector<string> cases = {
+        "", " ", "\n\n\n", "  a  ", "a\r\n\r\nb", "\n\r\n\n\n", "a \r b", "word-\n  next",
+        "end -\t\n\n wrap", "a - b", "--\n-", "text\n 12 \nmore", "\n1\n2\n3\n", "x\n\n 7\n\n\ny",
+        "one.\nthree", "Stop!\n\n  go", "Why?\n A", "a.\n", "\x01\n\x02\n\x7f\n\n", "tab\t\t\n\t",
+        "\v\fpage\f\v", "x\n12 \t", "-\n1\n.\nb", string("\0mid\0", 5), "a\xc3\xa9  \xe2\x80\x94-\nb",
+    };
+    for (size_t c = 0; c < cases.size(); ++c) {
+        check("case " + to_string(c), cases[c]);
+    }
+
+    // Random texts over the bytes the passes care about, plus filler
+    const string alphabet = string("      \n\n\n\r\t\v\f--..!?0123456789abcxyzABC\x01\x1f\x7f\xc3") + '\0';
+    mt19937 rng(12345);
+    for (int round = 0; round < 4000; ++round) {
+        size_t length = rng() % (round < 3000 ? 64 : 1024);
+        string input;
+        for (size_t i = 0; i < length; ++i) {
+            input += alphabet[rng() % alphabet.size()];
+        }
+        check("random text " + to_string(round), input);
+    }
+
+    for (int i = 1; i < argc; ++i) {
+        ifstream file(argv[i], ios::binary);
+        stringstream content;
+        content << file.rdbuf();
+        check(argv[i], content.str());
+    }
+
+    if (failures > 0) {
+        cout << "❌ " << failures << " mismatches\n";
+        return 1;
+    }
+    cout << "✅ Normalizer output matches the regex clean-up\n";
+    return 0;
+}
+EOF
+
+${CXX:-g++} -std=c++17 -O2 -I./src/document_processor \
+    "$BUILD_DIR/normalizer_equivalence.cpp" src/document_processor/TextNormalizer.cpp \
+    -o "$BUILD_DIR/normalizer_equivalence"
+
+# Any files given are checked as well
+"$BUILD_DIR/normalizer_equivalence" README.md config.yaml "$@"
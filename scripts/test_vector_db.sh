@@ -0,0 +1,341 @@
+#!/bin/bash
+set -e
+
+echo "🧪 Testing vector indexes: kernels, recall and index files..."
+
+# Ensure we're in the right directory
+if [ ! -f "Makefile" ]; then
+    echo "❌ Makefile not found. Are you in the project root?"
+    exit 1
+fi
+
+BUILD_DIR=$(mktemp -d)
+trap 'rm -rf "$BUILD_DIR"' EXIT
+
+cat > "$BUILD_DIR/vector_db_check.cpp" <<'EOF'
+#include "VectorIndex.h"
+#include "DistanceKernels.h"
+#include <iostream>
+#include <fstream>
+#include <random>
+#include <cmath>
+#include <cstring>
+#include <unordered_set>
+
+static int failures = 0;
+
+static void expect(bool condition, const string& what) {
+    if (!condition) {
+        cout << "❌ " << what << "\n";
+        ++failures;
+    }
+}
+
+static bool near(double a, double b, double tolerance) {
+    return fabs(a - b) <= tolerance * max(1.0, fabs(b));
+}
+
+// Every dispatched kernel against a plain double-precision loop, over
+// dimensions that exercise the SIMD tails
+static void checkKernels(mt19937& rng) {
+    const DistanceKernels& kernels = distanceKernels();
+    normal_distribution<float> gaussian;
+    const size_t dims[] = {1, 3, 7, 8, 15, 16, 17, 31, 64, 100, 128, 257};
+    const size_t count = 9;
+    for (size_t dim : dims) {
+        vector<float> query(dim), rows(count * dim);
+        for (auto& v : query) v = gaussian(rng);
+        for (auto& v : rows) v = gaussian(rng);
+        vector<float> ip(count), l2(count), fp16Ip(count), fp16L2(count);
+        kernels.innerProductBatch(query.data(), rows.data(), count, dim, ip.data());
+        kernels.l2SquaredBatch(query.data(), rows.data(), count, dim, l2.data());
+
+        vector<uint16_t> halves(count * dim);
+        for (size_t i = 0; i < halves.size(); ++i) halves[i] = floatToHalf(rows[i]);
+        kernels.fp16InnerProductBatch(query.data(), halves.data(), count, dim, fp16Ip.data());
+        kernels.fp16L2SquaredBatch(query.data(), halves.data(), count, dim, fp16L2.data());
+
+        vector<int8_t> q8(dim), rows8(count * dim);
+        uniform_int_distribution<int> int8Values(-127, 127);
+        for (auto& v : q8) v = static_cast<int8_t>(int8Values(rng));
+        for (auto& v : rows8) v = static_cast<int8_t>(int8Values(rng));
+        vector<int32_t> dot8(count);
+        kernels.int8DotBatch(q8.data(), rows8.data(), count, dim, dot8.data());
+
+        for (size_t r = 0; r < count; ++r) {
+            const float* row = &rows[r * dim];
+            double refIp = 0, refL2 = 0, refHalfIp = 0, refHalfL2 = 0;
+            int64_t refDot8 = 0;
+            for (size_t d = 0; d < dim; ++d) {
+                refIp += double(query[d]) * row[d];
+                refL2 += (double(query[d]) - row[d]) * (double(query[d]) - row[d]);
+                double half = halfToFloat(halves[r * dim + d]);
+                refHalfIp += double(query[d]) * half;
+                refHalfL2 += (double(query[d]) - half) * (double(query[d]) - half);
+                refDot8 += int32_t(q8[d]) * rows8[r * dim + d];
+            }
+            string where = string(kernels.name) + " dim " + to_string(dim);
+            expect(near(ip[r], refIp, 1e-4), "innerProductBatch differs, " + where);
+            expect(near(l2[r], refL2, 1e-4), "l2SquaredBatch differs, " + where);
+            expect(near(kernels.innerProduct(query.data(), row, dim), refIp, 1e-4), "innerProduct differs, " + where);
+            expect(near(kernels.l2Squared(query.data(), row, dim), refL2, 1e-4), "l2Squared differs, " + where);
+            expect(near(fp16Ip[r], refHalfIp, 1e-4), "fp16InnerProductBatch differs, " + where);
+            expect(near(fp16L2[r], refHalfL2, 1e-4), "fp16L2SquaredBatch differs, " + where);
+            expect(dot8[r] == refDot8, "int8DotBatch differs, " + where);
+        }
+    }
+
+    // Hamming over word counts around the 8-word AVX-512 step
+    for (size_t words : {1, 2, 5, 8, 9, 16}) {
+        vector<uint64_t> query(words), codes(count * words);
+        for (auto& w : query) w = (uint64_t(rng()) << 32) | rng();
+        for (auto& w : codes) w = (uint64_t(rng()) << 32) | rng();
+        vector<uint32_t> out(count);
+        kernels.hammingBatch(query.data(), codes.data(), count, words, out.data());
+        for (size_t r = 0; r < count; ++r) {
+            uint32_t ref = 0;
+            for (size_t w = 0; w < words; ++w) ref += __builtin_popcountll(query[w] ^ codes[r * words + w]);
+            expect(out[r] == ref, "hammingBatch differs, " + to_string(words) + " words");
+        }
+    }
+
+    // PQ lookups over a block layout of random codes
+    const size_t m = 8, blocks = 3;
+    vector<float> lut(m * PQ_KSUB);
+    for (auto& v : lut) v = gaussian(rng);
+    vector<uint8_t> codes(blocks * m * PQ_BLOCK);
+    for (auto& c : codes) c = static_cast<uint8_t>(rng());
+    vector<float> out(blocks * PQ_BLOCK);
+    kernels.pqLookupBlocks(lut.data(), codes.data(), blocks, m, out.data());
+    for (size_t b = 0; b < blocks; ++b) {
+        for (size_t j = 0; j < PQ_BLOCK; ++j) {
+            double ref = 0;
+            for (size_t s = 0; s < m; ++s) ref += lut[s * PQ_KSUB + codes[b * m * PQ_BLOCK + s * PQ_BLOCK + j]];
+            expect(near(out[b * PQ_BLOCK + j], ref, 1e-4), "pqLookupBlocks differs");
+        }
+    }
+}
+
+// Unit vectors around a few dozen centres, like embeddings of related text
+static vector<float> makeVectors(mt19937& rng, size_t count, size_t dim, const vector<float>& centres,
+                                 float spread) {
+    normal_distribution<float> gaussian;
+    size_t clusters = centres.size() / dim;
+    vector<float> vectors(count * dim);
+    for (size_t i = 0; i < count; ++i) {
+        const float* centre = &centres[(rng() % clusters) * dim];
+        float norm = 0;
+        for (size_t d = 0; d < dim; ++d) {
+            vectors[i * dim + d] = centre[d] + spread * gaussian(rng);
+            norm += vectors[i * dim + d] * vectors[i * dim + d];
+        }
+        for (size_t d = 0; d < dim; ++d) vectors[i * dim + d] /= sqrt(norm);
+    }
+    return vectors;
+}
+
+struct IndexCase {
+    string name;
+    string indexType;
+    string quantization;
+    double minRecall;
+};
+
+static shared_ptr<VectorIndex> makeIndex(const IndexCase& test) {
+    VectorDbConfig config;
+    config.index_type = test.indexType;
+    config.nlist = 32;
+    config.nprobe = 8;
+    config.pq_m = 16;
+    EmbeddingConfig embedding;
+    embedding.dim = 0;  // The first vector fixes it
+    embedding.quantization = test.quantization;
+    return createIndex(config, embedding);
+}
+
+static vector<SearchResult> searchAll(const VectorIndex& index, const vector<float>& queries, size_t dim, size_t k) {
+    vector<SearchResult> all;
+    for (size_t q = 0; q * dim < queries.size(); ++q) {
+        vector<float> query(queries.begin() + q * dim, queries.begin() + (q + 1) * dim);
+        vector<SearchResult> results = index.search(query, k);
+        results.resize(k, SearchResult{"", 0, 0.0f});
+        all.insert(all.end(), results.begin(), results.end());
+    }
+    return all;
+}
+
+static bool sameResults(const vector<SearchResult>& a, const vector<SearchResult>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i].id != b[i].id || a[i].row != b[i].row || !near(a[i].score, b[i].score, 1e-5)) return false;
+    }
+    return true;
+}
+
+static bool loadFails(const string& path) {
+    return loadIndexFile(path, VectorDbConfig(), SessionConfig()) == nullptr;
+}
+
+static void writeFile(const string& path, const string& bytes) {
+    ofstream(path, ios::binary | ios::trunc) << bytes;
+}
+
+static string readFile(const string& path) {
+    ifstream file(path, ios::binary);
+    return string(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+}
+
+// Saved files that are cut short or whose header lies must not load
+static void checkCorruptFiles(const string& name, const string& path, const string& dir) {
+    string bytes = readFile(path);
+    string corrupt = dir + "/corrupt.bin";
+    IndexFileHeader header;
+    memcpy(&header, bytes.data(), sizeof(header));
+
+    writeFile(corrupt, bytes.substr(0, sizeof(header) / 2));
+    expect(loadFails(corrupt), name + ": truncated header loaded");
+    writeFile(corrupt, bytes.substr(0, bytes.size() / 2));
+    expect(loadFails(corrupt), name + ": truncated body loaded");
+    writeFile(corrupt, bytes.substr(0, bytes.size() - 1));
+    expect(loadFails(corrupt), name + ": truncated id table loaded");
+
+    auto withHeader = [&](const IndexFileHeader& changed) {
+        string patched = bytes;
+        memcpy(&patched[0], &changed, sizeof(changed));
+        writeFile(corrupt, patched);
+        return loadFails(corrupt);
+    };
+    IndexFileHeader bad = header;
+    bad.magic[0] = 'X';
+    expect(withHeader(bad), name + ": bad magic loaded");
+    bad = header;
+    bad.version = INDEX_FILE_VERSION + 1;
+    expect(withHeader(bad), name + ": unknown version loaded");
+    bad = header;
+    bad.dim = 0;
+    expect(withHeader(bad), name + ": zero dimension loaded");
+    bad = header;
+    bad.metric = 7;
+    expect(withHeader(bad), name + ": unknown metric loaded");
+    bad = header;
+    bad.count = header.count * 4;
+    expect(withHeader(bad), name + ": inflated count loaded");
+    bad = header;
+    bad.count = ~uint64_t(0) / 2;
+    expect(withHeader(bad), name + ": overflowing count loaded");
+    bad = header;
+    bad.id_bytes = header.id_bytes + 1000;
+    expect(withHeader(bad), name + ": inflated id table loaded");
+}
+
+// HNSW link lists are checked against the graph before it is searched
+static void checkBadHnswLinks(const string& path, const string& dir) {
+    string bytes = readFile(path);
+    string corrupt = dir + "/corrupt.bin";
+    IndexFileHeader header;
+    memcpy(&header, bytes.data(), sizeof(header));
+    size_t maxM0 = 2 * size_t(header.params[0]);
+    // Level-0 links follow the vectors and one level byte per node; each
+    // node has a count and maxM0 slots
+    size_t linksOffset = sizeof(header) + header.count * header.dim * sizeof(float) + header.count;
+
+    auto withLinkWord = [&](size_t word, uint32_t value) {
+        string patched = bytes;
+        memcpy(&patched[linksOffset + word * sizeof(uint32_t)], &value, sizeof(value));
+        writeFile(corrupt, patched);
+        return loadFails(corrupt);
+    };
+    expect(withLinkWord(1, uint32_t(header.count)), "HNSW: link past the last node loaded");
+    expect(withLinkWord(1, 0xffffffffu), "HNSW: link of -1 loaded");
+    expect(withLinkWord(0, uint32_t(maxM0 + 1)), "HNSW: link count over the limit loaded");
+
+    string patched = bytes;
+    IndexFileHeader bad = header;
+    bad.params[3] = uint32_t(header.count);
+    memcpy(&patched[0], &bad, sizeof(bad));
+    writeFile(corrupt, patched);
+    expect(loadFails(corrupt), "HNSW: entry point past the last node loaded");
+}
+
+int main(int argc, char** argv) {
+    string dir = argc > 1 ? argv[1] : ".";
+    mt19937 rng(20240611);
+    checkKernels(rng);
+    cout << "✅ " << distanceKernels().name << " kernels checked against the scalar reference\n";
+
+    // Enough vectors that IVFPQ trains (256 * 39 for its codebooks)
+    const size_t dim = 64, count = 12000, queries = 100, k = 10;
+    vector<float> centres = makeVectors(rng, 48, dim, vector<float>(dim, 0.0f), 1.0f);
+    vector<float> vectors = makeVectors(rng, count, dim, centres, 0.1f);
+    vector<float> queryVectors = makeVectors(rng, queries, dim, centres, 0.1f);
+
+    const IndexCase flatCase = {"Flat", "IndexFlatIP", "float32", 1.0};
+    auto flat = makeIndex(flatCase);
+    for (size_t i = 0; i < count; ++i) flat->add("v" + to_string(i), &vectors[i * dim], dim);
+    vector<SearchResult> truth = searchAll(*flat, queryVectors, dim, k);
+
+    const vector<IndexCase> cases = {
+        flatCase,
+        {"Flat L2", "IndexFlatL2", "float32", 1.0},
+        {"IVF", "IndexIVFFlat", "float32", 0.85},
+        {"IVFPQ", "IndexIVFPQ", "float32", 0.8},
+        {"HNSW", "IndexHNSWFlat", "float32", 0.95},
+        {"SQ fp16", "IndexFlatIP", "fp16", 0.95},
+        {"SQ int8", "IndexFlatIP", "int8", 0.9},
+        {"Binary", "IndexBinaryFlat", "float32", 0.8},
+    };
+    for (const IndexCase& test : cases) {
+        auto index = makeIndex(test);
+        for (size_t i = 0; i < count; ++i) {
+            expect(index->add("v" + to_string(i), &vectors[i * dim], dim), test.name + ": add refused");
+        }
+        expect(!index->add("wrong", vector<float>(dim + 1, 0.1f)), test.name + ": wrong dimension added");
+        vector<SearchResult> results = searchAll(*index, queryVectors, dim, k);
+
+        // Recall@k against the exact inner-product top k (on unit vectors L2
+        // ranks the same)
+        size_t found = 0;
+        for (size_t q = 0; q < queries; ++q) {
+            unordered_set<string> exact;
+            for (size_t i = 0; i < k; ++i) exact.insert(truth[q * k + i].id);
+            for (size_t i = 0; i < k; ++i) found += exact.count(results[q * k + i].id);
+        }
+        double recall = double(found) / double(queries * k);
+        expect(recall >= test.minRecall, test.name + ": recall " + to_string(recall) + " below " +
+                                             to_string(test.minRecall));
+
+        // Round trip through faiss_index.bin
+        string path = dir + "/index.bin";
+        expect(index->save(path), test.name + ": save failed");
+        auto loaded = loadIndexFile(path, VectorDbConfig(), SessionConfig());
+        if (!loaded) {
+            expect(false, test.name + ": saved index did not load");
+            continue;
+        }
+        expect(loaded->getType() == index->getType() && loaded->size() == count && loaded->dimension() == dim &&
+                   loaded->getMetric() == index->getMetric(),
+               test.name + ": loaded index differs in shape");
+        expect(loaded->idAt(count - 1) == "v" + to_string(count - 1), test.name + ": ids lost on load");
+        expect(sameResults(searchAll(*loaded, queryVectors, dim, k), results),
+               test.name + ": loaded index answers differently");
+        checkCorruptFiles(test.name, path, dir);
+        if (test.indexType == "IndexHNSWFlat") {
+            checkBadHnswLinks(path, dir);
+        }
+        cout << "✅ " << test.name << ": recall@" << k << " " << recall << ", round trip and corrupt files checked\n";
+    }
+
+    if (failures > 0) {
+        cout << "❌ " << failures << " vector index checks failed\n";
+        return 1;
+    }
+    cout << "✅ Vector indexes match the exact search and their files\n";
+    return 0;
+}
+EOF
+
+${CXX:-g++} -std=c++17 -O2 -pthread -I./include -I./src/vector_db $CPPFLAGS \
+    "$BUILD_DIR/vector_db_check.cpp" src/vector_db/*.cpp src/config/ConfigManager.cpp \
+    -o "$BUILD_DIR/vector_db_check"
+
+"$BUILD_DIR/vector_db_check" "$BUILD_DIR"
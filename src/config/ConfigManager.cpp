@@ -33,28 +33,37 @@ bool ConfigManager::parseYamlFile(const string& filepath) {
     string line;
     string currentSection;
     string currentSubsection;
+    size_t subsectionIndent = 0;
     
     while (getline(file, line)) {
-        line = trim(line);
+        // Indentation decides nesting, so measure it before trimming
+        size_t indent = line.find_first_not_of(' ');
+        line = trim(stripComment(line));
         
         // Skip comments and empty lines
-        if (line.empty() || line[0] == '#') {
+        if (line.empty()) {
             continue;
         }
         
         // Check for section headers
-        if (line.back() == ':' && line.find("  ") != 0) {
+        if (line.back() == ':' && indent == 0) {
             currentSection = line.substr(0, line.length() - 1);
             currentSubsection.clear();
             continue;
         }
         
         // Check for subsection headers (indented)
-        if (line.find("  ") == 0 && line.back() == ':') {
-            currentSubsection = trim(line.substr(2, line.length() - 3));
+        if (line.back() == ':') {
+            currentSubsection = trim(line.substr(0, line.length() - 1));
+            subsectionIndent = indent;
             continue;
         }
         
+        // A key back at (or left of) the subsection's indent belongs to the section
+        if (!currentSubsection.empty() && indent <= subsectionIndent) {
+            currentSubsection.clear();
+        }
+        
         // Parse key-value pairs
         size_t colonPos = line.find(':');
         if (colonPos != string::npos) {
@@ -66,11 +75,6 @@ bool ConfigManager::parseYamlFile(const string& filepath) {
                 value = value.substr(1, value.length() - 2);
             }
             
-            // Remove leading spaces for indented keys
-            if (key.find("  ") == 0) {
-                key = key.substr(2);
-            }
-            
             // Apply configuration based on section
             applyConfig(currentSection, currentSubsection, key, value);
         }
@@ -99,6 +103,9 @@ void ConfigManager::applyConfig(const string& section, const string& subsection,
         else if (key == "preserve_sentences") document_processing.preserve_sentences = (value == "true");
         else if (key == "preserve_paragraphs") document_processing.preserve_paragraphs = (value == "true");
         else if (key == "max_file_size_mb") document_processing.max_file_size_mb = stoul(value);
+        else if (key == "enable_streaming") document_processing.enable_streaming = (value == "true");
+        else if (key == "stream_window_mb") document_processing.stream_window_mb = stoul(value);
+        else if (key == "max_stream_file_size_mb") document_processing.max_stream_file_size_mb = stoul(value);
         else if (key == "remove_extra_whitespace") document_processing.remove_extra_whitespace = (value == "true");
         else if (key == "normalize_unicode") document_processing.normalize_unicode = (value == "true");
         
@@ -124,7 +131,19 @@ void ConfigManager::applyConfig(const string& section, const string& subsection,
         if (subsection.empty()) {
             if (key == "model") embedding.model = value;
             else if (key == "dim") embedding.dim = stoi(value);
+            else if (key == "quantization") embedding.quantization = value;
+            else if (key == "backend") embedding.backend = value;
+            else if (key == "endpoint") embedding.endpoint = value;
+            else if (key == "unix_socket") embedding.unix_socket = value;
+            else if (key == "timeout_seconds") embedding.timeout_seconds = stoi(value);
+            else if (key == "max_retries") embedding.max_retries = stoi(value);
+            else if (key == "retry_backoff_ms") embedding.retry_backoff_ms = stoi(value);
+            else if (key == "breaker_failures") embedding.breaker_failures = stoi(value);
+            else if (key == "breaker_cooldown_seconds") embedding.breaker_cooldown_seconds = stoi(value);
+            else if (key == "response_format") embedding.response_format = value;
             else if (key == "batch_size") embedding.batch_size = stoi(value);
+            else if (key == "max_in_flight") embedding.max_in_flight = stoi(value);
+            else if (key == "query_prefix") embedding.query_prefix = value;
             else if (key == "python_path") embedding.python_path = value;
             else if (key == "script_path") embedding.script_path = value;
             else if (key == "semantic_search_enabled") embedding.semantic_search_enabled = (value == "true");
@@ -138,6 +157,15 @@ void ConfigManager::applyConfig(const string& section, const string& subsection,
             if (key == "index_type") vector_db.index_type = value;
             else if (key == "metric") vector_db.metric = value;
             else if (key == "nlist") vector_db.nlist = stoi(value);
+            else if (key == "nprobe") vector_db.nprobe = stoi(value);
+            else if (key == "hnsw_m") vector_db.hnsw_m = stoi(value);
+            else if (key == "ef_construction") vector_db.hnsw_ef_construction = stoi(value);
+            else if (key == "ef_search") vector_db.hnsw_ef_search = stoi(value);
+            else if (key == "pq_m") vector_db.pq_m = stoi(value);
+            else if (key == "rerank_factor") vector_db.pq_rerank_factor = stoi(value);
+            else if (key == "binary_candidates") vector_db.binary_candidates = stoi(value);
+            else if (key == "prefix_dim") vector_db.prefix_dim = stoi(value);
+            else if (key == "prefix_shortlist") vector_db.prefix_shortlist = stoi(value);
         }
     }
     else if (section == "chat") {
@@ -162,6 +190,7 @@ void ConfigManager::applyConfig(const string& section, const string& subsection,
     else if (section == "performance") {
         if (key == "enable_caching") performance.enable_caching = (value == "true");
         else if (key == "cache_size_mb") performance.cache_size_mb = stoi(value);
+        else if (key == "document_cache_max_mb") performance.document_cache_max_mb = stoi(value);
         else if (key == "parallel_processing") performance.parallel_processing = (value == "true");
         else if (key == "max_threads") performance.max_threads = stoi(value);
     }
@@ -177,6 +206,9 @@ void ConfigManager::applyConfig(const string& section, const string& subsection,
         else if (key == "max_sessions") session.max_sessions = stoi(value);
         else if (key == "cleanup_old_sessions") session.cleanup_old_sessions = (value == "true");
         else if (key == "max_session_age_days") session.max_session_age_days = stoi(value);
+        else if (key == "mmap_embeddings") session.mmap_embeddings = (value == "true");
+        else if (key == "mmap_populate") session.mmap_populate = (value == "true");
+        else if (key == "mmap_advice") session.mmap_advice = value;
     }
 }
 
@@ -205,6 +237,19 @@ string ConfigManager::trim(const string& str) {
     return str.substr(start, end - start + 1);
 }
 
+// Drops a trailing "# comment" that is not inside a quoted value
+string ConfigManager::stripComment(const string& line) {
+    bool inQuotes = false;
+    for (size_t i = 0; i < line.size(); ++i) {
+        if (line[i] == '"') {
+            inQuotes = !inQuotes;
+        } else if (line[i] == '#' && !inQuotes && (i == 0 || isspace(static_cast<unsigned char>(line[i - 1])))) {
+            return line.substr(0, i);
+        }
+    }
+    return line;
+}
+
 vector<string> ConfigManager::split(const string& str, char delimiter) {
     vector<string> tokens;
     stringstream ss(str);
@@ -28,6 +28,9 @@ struct DocumentProcessingConfig {
     bool preserve_sentences = true;
     bool preserve_paragraphs = true;
     size_t max_file_size_mb = 100;
+    bool enable_streaming = true;       // Stream larger text files instead of refusing them
+    size_t stream_window_mb = 8;        // Read, cleaned and chunked at a time when streaming
+    size_t max_stream_file_size_mb = 1024;  // Largest file streamed (its chunks stay in memory); 0 = no limit
     vector<string> supported_types = {"txt", "md", "pdf", "csv", "json"};
     bool remove_extra_whitespace = true;
     bool normalize_unicode = true;
@@ -39,12 +42,24 @@ struct DocumentProcessingConfig {
 };
 
 struct EmbeddingConfig {
-    std::string model;
-    int dim;
-    int batch_size;
-    std::string python_path;
-    std::string script_path;
-    bool semantic_search_enabled;
+    std::string model = "nomic-ai/nomic-embed-text-v2-moe";
+    int dim = 256;
+    std::string quantization = "float32";   // Flat index storage: float32, fp16 or int8
+    std::string query_prefix = "search_query: ";   // Prepended to questions before embedding
+    std::string backend = "server";         // server, or mock: deterministic hash vectors in-process
+    std::string endpoint = "http://127.0.0.1:8000";   // Embedding server (POST /embed)
+    std::string unix_socket = "";           // If set, reach the server over this socket instead of endpoint
+    int timeout_seconds = 60;               // Connect / read / write timeout per request
+    int max_retries = 3;                    // Extra attempts per batch after a transient failure
+    int retry_backoff_ms = 250;             // First retry delay, doubled per attempt
+    int breaker_failures = 5;               // Consecutive failures that mark the server down
+    int breaker_cooldown_seconds = 30;      // How long requests fail fast once it is down
+    std::string response_format = "json";   // json, float32 or fp16 (binary /embed/binary)
+    int batch_size = 16;
+    int max_in_flight = 4;                  // Concurrent /embed requests, capped by performance.max_threads
+    std::string python_path = "python3";
+    std::string script_path = "scripts/embedding_pipeline.py";
+    bool semantic_search_enabled = false;
 };
 
 struct VectorDbConfig {
@@ -52,6 +67,15 @@ struct VectorDbConfig {
     string index_type = "IndexFlatIP";
     string metric = "inner_product";
     int nlist = 100;
+    int nprobe = 8;
+    int hnsw_m = 16;
+    int hnsw_ef_construction = 200;
+    int hnsw_ef_search = 64;
+    int pq_m = 32;
+    int pq_rerank_factor = 4;
+    int binary_candidates = 256;
+    int prefix_dim = 0;
+    int prefix_shortlist = 256;
     map<string, string> provider_settings;
 };
 
@@ -76,6 +100,7 @@ struct LoggingConfig {
 struct PerformanceConfig {
     bool enable_caching = true;
     int cache_size_mb = 256;
+    int document_cache_max_mb = 1024;   // embedding_cache.bin cap, 0 = unbounded
     bool parallel_processing = true;
     int max_threads = 4;
 };
@@ -93,6 +118,9 @@ struct SessionConfig {
     int max_sessions = 100;
     bool cleanup_old_sessions = false;
     int max_session_age_days = 30;
+    bool mmap_embeddings = true;
+    bool mmap_populate = false;
+    string mmap_advice = "normal";
 };
 
 class ConfigManager {
@@ -152,6 +180,7 @@ private:
     void setDefaults();
     string trim(const string& str);
     vector<string> split(const string& str, char delimiter);
+    string stripComment(const string& line);
     void applyConfig(const string& section, const string& subsection, 
                     const string& key, const string& value);
 };
@@ -1,4 +1,6 @@
 #include "Chunker.h"
+#include "SeparatorIndex.h"
+#include "TextNormalizer.h"
 #include <fstream>
 #include <sstream>
 #include <algorithm>
@@ -45,6 +47,110 @@ vector<TextChunk> DocumentProcessor::processDocument(const string& filePath) {
     }
 }
 
+bool DocumentProcessor::streamDocument(const string& filePath, const ChunkSink& onChunks) {
+    struct stat fileStat;
+    if (config.enable_streaming && detectFileType(filePath) != "pdf" &&
+        stat(filePath.c_str(), &fileStat) == 0 &&
+        static_cast<size_t>(fileStat.st_size) > config.max_file_size_mb * 1024 * 1024) {
+        // Windows bound the raw text, but every chunk's text is kept by the
+        // session, so the whole file still ends up in memory
+        if (config.max_stream_file_size_mb > 0 &&
+            static_cast<size_t>(fileStat.st_size) > config.max_stream_file_size_mb * 1024 * 1024) {
+            cout << "⚠️  File too large to stream (>" << config.max_stream_file_size_mb << "MB): " << filePath
+                 << "\n";
+            return false;
+        }
+        return streamTextFile(filePath, onChunks);
+    }
+
+    vector<TextChunk> chunks = processDocument(filePath);
+    return chunks.empty() || onChunks(chunks);
+}
+
+bool DocumentProcessor::streamTextFile(const string& filePath, const ChunkSink& onChunks) {
+    ifstream file(filePath, ios::binary);
+    if (!file.is_open()) {
+        cout << "❌ Cannot open file: " << filePath << "\n";
+        return false;
+    }
+
+    size_t windowBytes = max(config.stream_window_mb, size_t(1)) * 1024 * 1024;
+    cout << "📄 Streaming " << detectFileType(filePath) << " file: " << filePath << " in "
+         << windowBytes / (1024 * 1024) << " MB windows\n";
+
+    // Only this window's raw bytes and the cleaned text from the next chunk's
+    // start on are held; chunks already handed on keep their window alive
+    // only as long as the sink holds them
+    string raw;
+    auto cleaned = make_shared<string>();
+    size_t cleanedOffset = 0;       // Of cleaned[0] in the whole cleaned text
+    size_t start = 0;               // Next chunk, in cleaned
+    bool leading = true;            // Still trimming the text's leading whitespace
+    int chunkIndex = 0;
+    string metadata = extractMetadata(filePath);
+
+    for (bool atEnd = false; !atEnd; ) {
+        size_t carried = raw.size();
+        raw.resize(carried + windowBytes);
+        file.read(&raw[carried], windowBytes);
+        raw.resize(carried + file.gcount());
+        atEnd = !file;
+
+        // Whitespace at the end of the window may continue in the next one,
+        // where cleaning could collapse it with what follows: carry it over
+        size_t cut = raw.size();
+        if (!atEnd) {
+            size_t lastText = raw.find_last_not_of(" \t\n\r");
+            cut = lastText == string::npos ? 0 : lastText + 1;
+        }
+
+        // The cleaned text left over from the last window, then this one.
+        // The overlap walk looks back from tentativeStart - 100 (unsigned),
+        // so 100 bytes before the next chunk stay to keep positions as large
+        // as they are in the whole text
+        size_t keepFrom = start > 100 ? start - 100 : 0;
+        auto next = make_shared<string>(*cleaned, keepFrom);
+        cleanedOffset += keepFrom;
+        start -= keepFrom;
+        size_t appendedAt = next->size();
+        appendNormalizedText(raw.data(), cut, config.remove_extra_whitespace, *next);
+        raw.erase(0, cut);
+        if (leading) {
+            size_t textStart = next->find_first_not_of(" \t\n", appendedAt);
+            next->erase(appendedAt, textStart == string::npos ? string::npos : textStart - appendedAt);
+            leading = textStart == string::npos;
+        }
+        if (atEnd) {
+            size_t textEnd = next->find_last_not_of(" \t\n");
+            next->erase(textEnd == string::npos ? 0 : textEnd + 1);
+        }
+        cleaned = next;
+
+        shared_ptr<const string> document = cleaned;
+        vector<SplitChunk> pieces;
+        if (atEnd && chunkIndex == 0 && cleanedOffset == 0 && document->length() <= config.chunk_size) {
+            // Short enough for one chunk, kept as is like splitTextIntoChunks does
+            if (!document->empty()) {
+                pieces.push_back({TextSpan(document, 0, document->length()), 0, document->length()});
+            }
+            start = document->length();
+        } else {
+            start = cutChunks(document, start, atEnd, pieces);
+        }
+
+        vector<TextChunk> chunks;
+        for (const SplitChunk& piece : pieces) {
+            chunks.push_back(makeTextChunk(piece, cleanedOffset, filePath, chunkIndex++, metadata));
+        }
+        if (!chunks.empty() && !onChunks(chunks)) {
+            return false;
+        }
+    }
+
+    cout << "📊 Created " << chunkIndex << " chunks from " << filePath << "\n";
+    return true;
+}
+
 vector<TextChunk> DocumentProcessor::processTxtFile(const string& filePath) {
     string content = readTextFile(filePath);
     if (content.empty()) {
@@ -52,8 +158,7 @@ vector<TextChunk> DocumentProcessor::processTxtFile(const string& filePath) {
         return {};
     }
     
-    content = cleanText(content);
-    return chunkText(content, filePath);
+    return chunkText(make_shared<const string>(cleanText(content)), filePath);
 }
 
 // 🆕 PRODUCTION PDF PROCESSING
@@ -76,12 +181,14 @@ vector<TextChunk> DocumentProcessor::processPdfFile(const string& filePath) {
             // Final fallback - create placeholder chunk
             TextChunk chunk;
             chunk.id = generateChunkId(filePath, 0);
-            chunk.content = "[PDF Document] " + filePath + " - Could not extract text. May be encrypted or image-only PDF.";
+            chunk.content = TextSpan("[PDF Document] " + filePath + " - Could not extract text. May be encrypted or image-only PDF.");
             chunk.source_file = filePath;
             chunk.chunk_index = 0;
             chunk.start_position = 0;
-            chunk.end_position = chunk.content.length();
-            chunk.token_count = estimateTokenCount(chunk.content);
+            chunk.end_position = chunk.content.length;
+            chunk.window_start = chunk.start_position;
+            chunk.window_end = chunk.end_position;
+            chunk.token_count = estimateTokenCount(chunk.content.view());
             chunk.metadata = "type:pdf,status:extraction_failed";
             
             return {chunk};
@@ -101,7 +208,7 @@ vector<TextChunk> DocumentProcessor::processPdfFile(const string& filePath) {
     cout << "📊 Extracted " << extractedText.length() << " characters from PDF\n";
     
     // Use your existing excellent chunking system
-    return chunkText(extractedText, filePath);
+    return chunkText(make_shared<const string>(move(extractedText)), filePath);
 }
 
 vector<TextChunk> DocumentProcessor::processMarkdownFile(const string& filePath) {
@@ -111,49 +218,44 @@ vector<TextChunk> DocumentProcessor::processMarkdownFile(const string& filePath)
     }
     
     // Clean markdown syntax for better chunking
-    content = cleanText(content);
-    
     // TODO: Implement markdown-specific processing (preserve headers, etc.)
-    return chunkText(content, filePath);
+    return chunkText(make_shared<const string>(cleanText(content)), filePath);
 }
 
-vector<TextChunk> DocumentProcessor::chunkText(const string& text, const string& sourceFile) {
+vector<TextChunk> DocumentProcessor::chunkText(const shared_ptr<const string>& document, const string& sourceFile) {
     vector<TextChunk> chunks;
-    vector<string> textChunks = splitTextIntoChunks(text);
+    vector<SplitChunk> textChunks = splitTextIntoChunks(document);
     
     cout << "📊 Created " << textChunks.size() << " chunks from " << sourceFile << "\n";
     
-    size_t currentPosition = 0;
-    
+    string metadata = extractMetadata(sourceFile);
     for (size_t i = 0; i < textChunks.size(); ++i) {
-        TextChunk chunk;
-        chunk.id = generateChunkId(sourceFile, i);
-        chunk.content = textChunks[i];
-        chunk.source_file = sourceFile;
-        chunk.chunk_index = i;
-        
-        // Calculate actual positions in original text
-        size_t chunkStart = text.find(chunk.content, currentPosition);
-        if (chunkStart != string::npos) {
-            chunk.start_position = chunkStart;
-            chunk.end_position = chunkStart + chunk.content.length();
-            currentPosition = chunkStart + chunk.content.length();
-        } else {
-            // Fallback if exact match not found
-            chunk.start_position = currentPosition;
-            chunk.end_position = currentPosition + chunk.content.length();
-            currentPosition = chunk.end_position;
-        }
-        
-        chunk.token_count = estimateTokenCount(chunk.content);
-        chunk.metadata = extractMetadata(sourceFile);
-        
-        chunks.push_back(chunk);
+        chunks.push_back(makeTextChunk(textChunks[i], 0, sourceFile, i, metadata));
     }
     
     return chunks;
 }
 
+TextChunk DocumentProcessor::makeTextChunk(const SplitChunk& piece, size_t documentOffset,
+                                           const string& sourceFile, int chunkIndex, const string& metadata) {
+    TextChunk chunk;
+    chunk.id = generateChunkId(sourceFile, chunkIndex);
+    chunk.content = piece.content;
+    chunk.source_file = sourceFile;
+    chunk.chunk_index = chunkIndex;
+    
+    // The splitter knows exactly where each chunk came from; documentOffset
+    // places a streamed window within the whole cleaned text
+    chunk.start_position = documentOffset + piece.content.offset;
+    chunk.end_position = chunk.start_position + piece.content.length;
+    chunk.window_start = documentOffset + piece.window_start;
+    chunk.window_end = documentOffset + piece.window_end;
+    
+    chunk.token_count = estimateTokenCount(chunk.content.view());
+    chunk.metadata = metadata;
+    return chunk;
+}
+
 string DocumentProcessor::detectFileType(const string& filePath) {
     size_t lastDot = filePath.find_last_of('.');
     if (lastDot == string::npos) {
@@ -202,62 +304,66 @@ string DocumentProcessor::readTextFile(const string& filePath) {
 }
 
 string DocumentProcessor::cleanText(const string& text) {
-    string cleaned = text;
+    // Collapse extra spaces / blank lines, drop carriage returns, trim
+    return normalizeText(text, config.remove_extra_whitespace);
+}
+
+vector<SplitChunk> DocumentProcessor::splitTextIntoChunks(const shared_ptr<const string>& document) {
+    vector<SplitChunk> chunks;
+    const string& text = *document;
     
-    if (config.remove_extra_whitespace) {
-        // Remove excessive whitespace
-        regex multipleSpaces("  +");
-        cleaned = regex_replace(cleaned, multipleSpaces, " ");
-        
-        // Remove excessive newlines
-        regex multipleNewlines("\n\n\n+");
-        cleaned = regex_replace(cleaned, multipleNewlines, "\n\n");
-        
-        // Remove carriage returns
-        regex carriageReturns("\r");
-        cleaned = regex_replace(cleaned, carriageReturns, "");
+    if (text.length() <= config.chunk_size) {
+        chunks.push_back({TextSpan(document, 0, text.length()), 0, text.length()});
+        return chunks;
     }
     
-    // Trim leading/trailing whitespace
-    size_t start = cleaned.find_first_not_of(" \t\n");
-    if (start == string::npos) return "";
-    
-    size_t end = cleaned.find_last_not_of(" \t\n");
-    cleaned = cleaned.substr(start, end - start + 1);
-    
-    return cleaned;
+    cutChunks(document, 0, true, chunks);
+    return chunks;
 }
 
-vector<string> DocumentProcessor::splitTextIntoChunks(const string& text) {
-    vector<string> chunks;
+size_t DocumentProcessor::cutChunks(const shared_ptr<const string>& document, size_t start, bool atEnd,
+                                    vector<SplitChunk>& chunks) {
+    const string& text = *document;
     
-    if (text.length() <= config.chunk_size) {
-        chunks.push_back(text);
-        return chunks;
+    // A break can be a separator starting at the window's end, and the
+    // overlap walk reads one byte past it: without all of that in text, the
+    // chunk has to wait for more
+    size_t lookahead = 2;
+    for (const string& separator : config.separators) {
+        lookahead = max(lookahead, separator.length());
     }
     
-    size_t start = 0;
+    // Each window is scanned once for every separator (and, last, a space
+    // for the word-boundary fallback)
+    vector<string> breakPatterns = config.separators;
+    breakPatterns.push_back(" ");
+    SeparatorIndex separatorIndex(breakPatterns);
+    const size_t spacePattern = config.separators.size();
     
     while (start < text.length()) {
+        if (!atEnd && start + config.chunk_size + lookahead > text.length()) {
+            break;
+        }
         size_t end = min(start + config.chunk_size, text.length());
         
         // If we're not at the end of text, find a good break point
         if (end < text.length()) {
             size_t bestBreak = end;
+            separatorIndex.scanWindow(text, start, end);
             
             // Try to break at separators in order of preference
-            for (const string& separator : config.separators) {
-                size_t breakPoint = text.rfind(separator, end);
-                if (breakPoint != string::npos && breakPoint > start) {
-                    bestBreak = breakPoint + separator.length();
+            for (size_t s = 0; s < config.separators.size(); ++s) {
+                size_t breakPoint = separatorIndex.lastInWindow(s);
+                if (breakPoint != string::npos) {
+                    bestBreak = breakPoint + config.separators[s].length();
                     break;
                 }
             }
             
             // If no separator found, try to break at word boundary
             if (bestBreak == end) {
-                size_t spacePos = text.rfind(' ', end);
-                if (spacePos != string::npos && spacePos > start) {
+                size_t spacePos = separatorIndex.lastInWindow(spacePattern);
+                if (spacePos != string::npos) {
                     bestBreak = spacePos + 1;
                 }
             }
@@ -265,18 +371,17 @@ vector<string> DocumentProcessor::splitTextIntoChunks(const string& text) {
             end = bestBreak;
         }
         
-        string chunk = text.substr(start, end - start);
-        
-        // Clean up the chunk
-        chunk = cleanChunk(chunk);
+        // Clean up the chunk (by narrowing it; nothing is copied)
+        string_view chunk = cleanChunk(string_view(text).substr(start, end - start));
         
         if (!chunk.empty()) {
-            chunks.push_back(chunk);
+            TextSpan content(document, chunk.data() - text.data(), chunk.length());
+            chunks.push_back({move(content), start, end});
         }
         
         // Calculate next start position with proper overlap
         if (end >= text.length()) {
-            break;
+            return text.length();
         }
         
         // Apply overlap: move back by overlap amount, but ensure we make progress
@@ -328,25 +433,25 @@ vector<string> DocumentProcessor::splitTextIntoChunks(const string& text) {
             }
         }
 
-        start = tentativeStart;
-
-        // Ensure we don't get stuck in infinite loop
-        if (start >= end) {
-            start = end;
+        // Ensure we don't get stuck in infinite loop: the overlap walk can
+        // land back on (or before) this chunk's start
+        if (tentativeStart >= end || tentativeStart <= start) {
+            tentativeStart = end;
         }
+        start = tentativeStart;
     }
     
-    return chunks;
+    return start;
 }
 
-string DocumentProcessor::cleanChunk(const string& chunk) {
-    if (chunk.empty()) return "";
+string_view DocumentProcessor::cleanChunk(string_view chunk) {
+    if (chunk.empty()) return {};
     
-    string cleaned = chunk;
+    string_view cleaned = chunk;
     
     // Remove leading/trailing whitespace
     size_t start = cleaned.find_first_not_of(" \t\n\r");
-    if (start == string::npos) return "";
+    if (start == string_view::npos) return {};
     
     size_t end = cleaned.find_last_not_of(" \t\n\r");
     cleaned = cleaned.substr(start, end - start + 1);
@@ -360,7 +465,7 @@ string DocumentProcessor::cleanChunk(const string& chunk) {
         cleaned = cleaned.substr(1);
         // Remove any whitespace after removing punctuation
         size_t newStart = cleaned.find_first_not_of(" \t");
-        if (newStart != string::npos) {
+        if (newStart != string_view::npos) {
             cleaned = cleaned.substr(newStart);
         }
     }
@@ -368,10 +473,10 @@ string DocumentProcessor::cleanChunk(const string& chunk) {
     // Remove orphaned opening brackets/parentheses at the end
     if (!cleaned.empty() && 
         (cleaned.back() == '(' || cleaned.back() == '[' || cleaned.back() == '{')) {
-        cleaned.pop_back();
+        cleaned.remove_suffix(1);
         // Remove trailing whitespace
         while (!cleaned.empty() && (cleaned.back() == ' ' || cleaned.back() == '\t')) {
-            cleaned.pop_back();
+            cleaned.remove_suffix(1);
         }
     }
     
@@ -379,10 +484,10 @@ string DocumentProcessor::cleanChunk(const string& chunk) {
     if (!cleaned.empty() && cleaned.length() > 3) {
         // Check if first word is incomplete (no capital letter, very short)
         size_t firstSpace = cleaned.find(' ');
-        if (firstSpace != string::npos && firstSpace < 5) {
-            string firstWord = cleaned.substr(0, firstSpace);
+        if (firstSpace != string_view::npos && firstSpace < 5) {
+            string_view firstWord = cleaned.substr(0, firstSpace);
             // If first word is very short and lowercase, it might be incomplete
-            if (firstWord.length() <= 3 && islower(firstWord[0])) {
+            if (!firstWord.empty() && firstWord.length() <= 3 && islower(firstWord[0])) {
                 // Skip the incomplete word
                 cleaned = cleaned.substr(firstSpace + 1);
             }
@@ -398,7 +503,7 @@ string DocumentProcessor::generateChunkId(const string& sourceFile, int chunkInd
     return "chunk_" + to_string(fileHash) + "_" + to_string(chunkIndex);
 }
 
-size_t DocumentProcessor::estimateTokenCount(const string& text) {
+size_t DocumentProcessor::estimateTokenCount(string_view text) {
     // Rough token estimation: average 4 characters per token
     return text.length() / 4;
 }
@@ -634,38 +739,9 @@ string DocumentProcessor::getPdfInfo(const string& filePath) {
 }
 
 string DocumentProcessor::cleanPdfText(const string& text) {
-    string cleaned = text;
-    
-    // Remove PDF-specific artifacts
-    
-    // 1. Fix hyphenated words across lines
-    regex hyphenNewline("-\\s*\\n\\s*");
-    cleaned = regex_replace(cleaned, hyphenNewline, "");
-    
-    // 2. Fix excessive spacing from layout preservation
-    regex excessiveSpaces("  +");
-    cleaned = regex_replace(cleaned, excessiveSpaces, " ");
-    
-    // 3. Remove page numbers and headers/footers (common patterns)
-    regex pageNumbers("\\n\\s*\\d+\\s*\\n");
-    cleaned = regex_replace(cleaned, pageNumbers, "\n\n");
-    
-    // 4. Fix broken sentences from column layouts
-    regex brokenSentences("([.!?])\\s*\\n\\s*([a-z])");
-    cleaned = regex_replace(cleaned, brokenSentences, "$1 $2");
-    
-    // 5. Remove OCR artifacts
-    regex ocrArtifacts("[\\x00-\\x08\\x0B\\x0C\\x0E-\\x1F\\x7F]");
-    cleaned = regex_replace(cleaned, ocrArtifacts, "");
-    
-    // 6. Clean up multiple newlines
-    regex multipleNewlines("\\n\\n\\n+");
-    cleaned = regex_replace(cleaned, multipleNewlines, "\n\n");
-    
-    // 7. Trim whitespace
-    cleaned = regex_replace(cleaned, regex("^\\s+|\\s+$"), "");
-    
-    return cleaned;
+    // Remove PDF-specific artifacts: hyphenated line breaks, layout spacing,
+    // page numbers, column-broken sentences, OCR control characters
+    return normalizePdfText(text);
 }
 
 string DocumentProcessor::tryAlternativeExtraction(const string& filePath) {
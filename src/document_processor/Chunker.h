@@ -2,28 +2,74 @@
 #define CHUNKER_H
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <memory>
+#include <functional>
 #include "../config/ConfigManager.h"
 
 using namespace std;
 
+// [offset, offset + length) of an immutable document shared by reference
+// count. Chunks point into the cleaned text this way rather than each
+// holding a copy; a string is only made when one is needed (e.g. for
+// session storage)
+struct TextSpan {
+    shared_ptr<const string> document;
+    size_t offset = 0;
+    size_t length = 0;
+
+    TextSpan() = default;
+    TextSpan(shared_ptr<const string> document, size_t offset, size_t length)
+        : document(move(document)), offset(offset), length(length) {}
+    // A span over a buffer of its own
+    explicit TextSpan(string text)
+        : document(make_shared<const string>(move(text))), offset(0), length(document->length()) {}
+
+    string_view view() const {
+        return document ? string_view(*document).substr(offset, length) : string_view();
+    }
+    string str() const { return string(view()); }
+};
+
+// A chunk as cut by splitTextIntoChunks: the cleaned content, and the
+// window [window_start, window_end) of the text it was cut from before
+// cleanChunk trimmed it
+struct SplitChunk {
+    TextSpan content;
+    size_t window_start;
+    size_t window_end;
+};
+
 struct TextChunk {
     string id;
-    string content;
+    TextSpan content;
     string source_file;
     int chunk_index;
-    size_t start_position;
-    size_t end_position;
+    size_t start_position;      // content is exactly [start_position, end_position)
+    size_t end_position;        // of the cleaned document text
+    size_t window_start;        // Splitter window, before cleanChunk
+    size_t window_end;
     size_t token_count;
     string metadata;
 };
 
+// Takes the chunks cut from one window of a streamed file, in order;
+// returning false stops the stream
+typedef function<bool(vector<TextChunk>& chunks)> ChunkSink;
+
 class DocumentProcessor {
 public:
     DocumentProcessor(); 
     // Main processing method
     vector<TextChunk> processDocument(const string& filePath);
+    // Like processDocument, but text files over max_file_size_mb are read,
+    // cleaned and chunked stream_window_mb at a time (when enable_streaming),
+    // each window's chunks going to onChunks before the next is read; files
+    // over max_stream_file_size_mb are refused. Other
+    // documents reach onChunks in one call. The chunks are the same either
+    // way; false if the file could not be read or onChunks stopped it
+    bool streamDocument(const string& filePath, const ChunkSink& onChunks);
     
     // Configuration methods
     void updateConfig();  // Reload config settings
@@ -35,22 +81,30 @@ public:
     vector<TextChunk> processMarkdownFile(const string& filePath);
     
     // Text chunking methods
-    vector<TextChunk> chunkText(const string& text, const string& sourceFile);
+    vector<TextChunk> chunkText(const shared_ptr<const string>& document, const string& sourceFile);
     
     // Utility methods
     string detectFileType(const string& filePath);
     string readTextFile(const string& filePath);
     string cleanText(const string& text);
-    vector<string> splitTextIntoChunks(const string& text);
+    vector<SplitChunk> splitTextIntoChunks(const shared_ptr<const string>& document);
 
 private:
     DocumentProcessingConfig config;
     
     // Helper methods
     string generateChunkId(const string& sourceFile, int chunkIndex);
-    size_t estimateTokenCount(const string& text);
+    size_t estimateTokenCount(string_view text);
+    TextChunk makeTextChunk(const SplitChunk& piece, size_t documentOffset, const string& sourceFile,
+                            int chunkIndex, const string& metadata);
+    // Cuts chunks from text[start...]. Unless atEnd, stops at the first chunk
+    // whose window could still change with more text; returns where the next
+    // chunk starts
+    size_t cutChunks(const shared_ptr<const string>& document, size_t start, bool atEnd,
+                     vector<SplitChunk>& chunks);
+    bool streamTextFile(const string& filePath, const ChunkSink& onChunks);
     string extractMetadata(const string& sourceFile);
-    string cleanChunk(const string& chunk);
+    string_view cleanChunk(string_view chunk);  // Trims; the result is a piece of chunk
     vector<size_t> findSentenceBoundaries(const string& text);
     vector<size_t> findParagraphBoundaries(const string& text);
     
@@ -0,0 +1,44 @@
+#include "SeparatorIndex.h"
+#include <algorithm>
+#include <cstring>
+
+SeparatorIndex::SeparatorIndex(const vector<string>& patterns)
+    : patterns(patterns), byFirstByte(256), last(patterns.size(), string::npos) {
+    // Patterns grouped by first byte; most bytes start none
+    for (size_t p = 0; p < patterns.size(); ++p) {
+        if (!patterns[p].empty()) {
+            byFirstByte[static_cast<unsigned char>(patterns[p][0])].push_back(p);
+        }
+    }
+}
+
+void SeparatorIndex::scanWindow(const string& text, size_t after, size_t upTo) {
+    const char* data = text.data();
+    size_t length = text.length();
+    size_t missing = 0;
+    for (size_t p = 0; p < patterns.size(); ++p) {
+        if (patterns[p].empty()) {
+            // rfind("", upTo) answers min(upTo, length)
+            size_t position = min(upTo, length);
+            last[p] = position > after ? position : string::npos;
+        } else {
+            last[p] = string::npos;
+            ++missing;
+        }
+    }
+
+    // Walking back from the window's end, the first match of a pattern is
+    // its last one; stop once every pattern has one
+    size_t i = min(upTo, length == 0 ? 0 : length - 1);
+    for (; missing > 0 && i > after && i < length; --i) {
+        const vector<size_t>& candidates = byFirstByte[static_cast<unsigned char>(data[i])];
+        for (size_t p : candidates) {
+            const string& pattern = patterns[p];
+            if (last[p] == string::npos && pattern.length() <= length - i &&
+                memcmp(data + i + 1, pattern.data() + 1, pattern.length() - 1) == 0) {
+                last[p] = i;
+                --missing;
+            }
+        }
+    }
+}
@@ -0,0 +1,37 @@
+#ifndef SEPARATOR_INDEX_H
+#define SEPARATOR_INDEX_H
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+using namespace std;
+
+// Finds the last occurrence of each of a set of short patterns (the chunk
+// separators) inside one chunk window, in a single backward pass: each byte
+// is looked up in a table of the patterns starting with it, and only those
+// are compared. Occurrences may overlap, exactly as rfind() would report
+// them.
+//
+// Only the window is scanned, so a separator missing from it no longer sends
+// rfind() back towards the start of the text, and nothing is kept per
+// occurrence: memory is one slot per pattern however long the text is.
+class SeparatorIndex {
+public:
+    explicit SeparatorIndex(const vector<string>& patterns);
+
+    // Scans text for patterns starting in (after, upTo]; a pattern may run
+    // past upTo. The results are read with lastInWindow()
+    void scanWindow(const string& text, size_t after, size_t upTo);
+
+    // Start of the last occurrence of patterns[pattern] found by the last
+    // scanWindow(), or string::npos. An empty pattern occurs everywhere.
+    size_t lastInWindow(size_t pattern) const { return last[pattern]; }
+
+private:
+    vector<string> patterns;
+    vector<vector<size_t>> byFirstByte;  // Pattern numbers, by their first byte
+    vector<size_t> last;                 // Per pattern, from the last scan
+};
+
+#endif // SEPARATOR_INDEX_H
@@ -0,0 +1,349 @@
+#include "TextNormalizer.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define MIMIR_X86_SCAN 1
+#endif
+
+// ---------------------------------------------------------------------------
+// Byte classes
+// ---------------------------------------------------------------------------
+
+// The set of bytes one pass has to look at. Besides a plain table, it keeps
+// two 16-entry nibble tables for the SIMD scan: byte b is a member iff
+// lowTable[b & 15] & highTable[b >> 4] is non-zero. Each high nibble gets
+// the bit of its group (high nibbles with the same set of low nibbles share
+// a group), which works for classes of up to 8 groups.
+struct ByteClass {
+    bool member[256] = {};
+    uint8_t lowTable[16] = {};
+    uint8_t highTable[16] = {};
+    bool nibbleTables = false;
+};
+
+template <typename Predicate>
+static ByteClass makeByteClass(Predicate isMember) {
+    ByteClass cls;
+    uint16_t lowsOfHigh[16] = {};
+    for (int b = 0; b < 256; ++b) {
+        cls.member[b] = isMember(static_cast<unsigned char>(b));
+        if (cls.member[b]) {
+            lowsOfHigh[b >> 4] |= uint16_t(1u << (b & 15));
+        }
+    }
+
+    uint16_t groups[8];
+    int groupCount = 0;
+    for (int high = 0; high < 16; ++high) {
+        if (lowsOfHigh[high] == 0) {
+            continue;
+        }
+        int group = 0;
+        while (group < groupCount && groups[group] != lowsOfHigh[high]) {
+            ++group;
+        }
+        if (group == groupCount) {
+            if (groupCount == 8) {
+                return cls;     // Scalar scan only
+            }
+            groups[groupCount++] = lowsOfHigh[high];
+        }
+        cls.highTable[high] = uint8_t(1u << group);
+    }
+    for (int group = 0; group < groupCount; ++group) {
+        for (int low = 0; low < 16; ++low) {
+            if (groups[group] & (1u << low)) {
+                cls.lowTable[low] |= uint8_t(1u << group);
+            }
+        }
+    }
+    cls.nibbleTables = true;
+    return cls;
+}
+
+// std::regex's \s in the classic locale
+static inline bool isRegexSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+}
+
+static inline bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+// ---------------------------------------------------------------------------
+// Scanning: index of the first member in [from, length), or length
+// ---------------------------------------------------------------------------
+
+static size_t findMemberScalar(const ByteClass& cls, const char* data, size_t from, size_t length) {
+    for (size_t i = from; i < length; ++i) {
+        if (cls.member[static_cast<unsigned char>(data[i])]) {
+            return i;
+        }
+    }
+    return length;
+}
+
+#ifdef MIMIR_X86_SCAN
+
+__attribute__((target("avx2")))
+static size_t findMemberAvx2(const ByteClass& cls, const char* data, size_t from, size_t length) {
+    if (!cls.nibbleTables) {
+        return findMemberScalar(cls, data, from, length);
+    }
+    const __m256i lowTable = _mm256_broadcastsi128_si256(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(cls.lowTable)));
+    const __m256i highTable = _mm256_broadcastsi128_si256(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(cls.highTable)));
+    const __m256i nibbleMask = _mm256_set1_epi8(0x0F);
+    const __m256i zero = _mm256_setzero_si256();
+
+    size_t i = from;
+    for (; i + 32 <= length; i += 32) {
+        __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        __m256i lows = _mm256_and_si256(bytes, nibbleMask);
+        __m256i highs = _mm256_and_si256(_mm256_srli_epi16(bytes, 4), nibbleMask);
+        __m256i hits = _mm256_and_si256(_mm256_shuffle_epi8(lowTable, lows),
+                                        _mm256_shuffle_epi8(highTable, highs));
+        uint32_t members = ~static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(hits, zero)));
+        if (members != 0) {
+            return i + __builtin_ctz(members);
+        }
+    }
+    return findMemberScalar(cls, data, i, length);
+}
+
+#endif // MIMIR_X86_SCAN
+
+typedef size_t (*FindMember)(const ByteClass& cls, const char* data, size_t from, size_t length);
+
+static FindMember resolveFindMember() {
+#ifdef MIMIR_X86_SCAN
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return findMemberAvx2;
+    }
+#endif
+    return findMemberScalar;
+}
+
+static size_t findMember(const ByteClass& cls, const char* data, size_t from, size_t length) {
+    static const FindMember find = resolveFindMember();
+    return find(cls, data, from, length);
+}
+
+// ---------------------------------------------------------------------------
+// Passes. Each reads in and appends to out, and reproduces one or two of the
+// regex replacements exactly (leftmost, non-overlapping matches over the
+// pass's input; runs that the next regex would see are checked on out).
+// ---------------------------------------------------------------------------
+
+// "  +" -> " ", "\n\n\n+" -> "\n\n", "\r" -> ""
+static void collapseSpacesAndNewlines(const char* data, size_t length, string& out) {
+    static const ByteClass special = makeByteClass([](unsigned char c) {
+        return c == ' ' || c == '\n' || c == '\r';
+    });
+    size_t i = 0;
+    while (i < length) {
+        size_t next = findMember(special, data, i, length);
+        out.append(data + i, next - i);
+        if (next == length) {
+            break;
+        }
+        char c = data[next];
+        size_t runEnd = next + 1;
+        while (runEnd < length && data[runEnd] == c) {
+            ++runEnd;
+        }
+        // The space and newline regexes ran before "\r" was removed, so a
+        // carriage return still separates runs
+        if (c == ' ') {
+            out += ' ';
+        } else if (c == '\n') {
+            out.append(min(runEnd - next, size_t(2)), '\n');
+        }
+        i = runEnd;
+    }
+}
+
+// "-\s*\n\s*" -> "" (hyphenated line breaks), then "  +" -> " "
+static void joinHyphensAndCollapseSpaces(const string& in, string& out) {
+    static const ByteClass special = makeByteClass([](unsigned char c) {
+        return c == '-' || c == ' ';
+    });
+    const char* data = in.data();
+    size_t length = in.length();
+    size_t i = 0;
+    while (i < length) {
+        size_t next = findMember(special, data, i, length);
+        out.append(data + i, next - i);
+        if (next == length) {
+            break;
+        }
+        if (data[next] == ' ') {
+            if (out.empty() || out.back() != ' ') {
+                out += ' ';
+            }
+            i = next + 1;
+            continue;
+        }
+        // The hyphen and the whole whitespace run after it go, provided the
+        // run breaks a line
+        size_t runEnd = next + 1;
+        bool newline = false;
+        while (runEnd < length && isRegexSpace(data[runEnd])) {
+            newline = newline || data[runEnd] == '\n';
+            ++runEnd;
+        }
+        if (newline) {
+            i = runEnd;
+        } else {
+            out += '-';
+            i = next + 1;
+        }
+    }
+}
+
+// "\n\s*\d+\s*\n" -> "\n\n" (a line holding only a page number)
+static void removePageNumbers(const string& in, string& out) {
+    static const ByteClass special = makeByteClass([](unsigned char c) {
+        return c == '\n';
+    });
+    const char* data = in.data();
+    size_t length = in.length();
+    size_t i = 0;
+    while (i < length) {
+        size_t next = findMember(special, data, i, length);
+        out.append(data + i, next - i);
+        if (next == length) {
+            break;
+        }
+        size_t digits = next + 1;
+        while (digits < length && isRegexSpace(data[digits])) {
+            ++digits;
+        }
+        size_t digitsEnd = digits;
+        while (digitsEnd < length && isDigit(data[digitsEnd])) {
+            ++digitsEnd;
+        }
+        if (digitsEnd > digits) {
+            // The match runs to the last newline of the whitespace after the number
+            size_t lastNewline = string::npos;
+            for (size_t k = digitsEnd; k < length && isRegexSpace(data[k]); ++k) {
+                if (data[k] == '\n') {
+                    lastNewline = k;
+                }
+            }
+            if (lastNewline != string::npos) {
+                out += "\n\n";
+                i = lastNewline + 1;
+                continue;
+            }
+        }
+        // No other newline of this whitespace run can start a match either
+        out.append(data + next, digits - next);
+        i = digits;
+    }
+}
+
+// "([.!?])\s*\n\s*([a-z])" -> "$1 $2" (sentence broken across column lines)
+static void joinBrokenSentences(const string& in, string& out) {
+    static const ByteClass special = makeByteClass([](unsigned char c) {
+        return c == '.' || c == '!' || c == '?';
+    });
+    const char* data = in.data();
+    size_t length = in.length();
+    size_t i = 0;
+    while (i < length) {
+        size_t next = findMember(special, data, i, length);
+        out.append(data + i, next - i);
+        if (next == length) {
+            break;
+        }
+        out += data[next];
+        size_t runEnd = next + 1;
+        bool newline = false;
+        while (runEnd < length && isRegexSpace(data[runEnd])) {
+            newline = newline || data[runEnd] == '\n';
+            ++runEnd;
+        }
+        if (newline && runEnd < length && data[runEnd] >= 'a' && data[runEnd] <= 'z') {
+            out += ' ';
+            out += data[runEnd];
+            i = runEnd + 1;
+        } else {
+            i = next + 1;
+        }
+    }
+}
+
+// "[\x00-\x08\x0B\x0C\x0E-\x1F\x7F]" -> "", then "\n\n\n+" -> "\n\n"
+static void stripControlsAndBlankLines(const string& in, string& out) {
+    static const ByteClass special = makeByteClass([](unsigned char c) {
+        return (c < 0x20 && c != '\t' && c != '\r') || c == 0x7F;
+    });
+    const char* data = in.data();
+    size_t length = in.length();
+    size_t i = 0;
+    while (i < length) {
+        size_t next = findMember(special, data, i, length);
+        out.append(data + i, next - i);
+        if (next == length) {
+            break;
+        }
+        // Newlines that only meet once the controls are gone still collapse
+        if (data[next] == '\n' &&
+            !(out.size() >= 2 && out[out.size() - 1] == '\n' && out[out.size() - 2] == '\n')) {
+            out += '\n';
+        }
+        i = next + 1;
+    }
+}
+
+static void trim(string& text, const char* whitespace) {
+    size_t start = text.find_first_not_of(whitespace);
+    if (start == string::npos) {
+        text.clear();
+        return;
+    }
+    text.erase(text.find_last_not_of(whitespace) + 1);
+    text.erase(0, start);
+}
+
+string normalizeText(const string& text, bool collapseWhitespace) {
+    string cleaned;
+    if (collapseWhitespace) {
+        cleaned.reserve(text.length());
+        collapseSpacesAndNewlines(text.data(), text.length(), cleaned);
+    } else {
+        cleaned = text;
+    }
+    trim(cleaned, " \t\n");
+    return cleaned;
+}
+
+void appendNormalizedText(const char* data, size_t length, bool collapseWhitespace, string& out) {
+    if (collapseWhitespace) {
+        collapseSpacesAndNewlines(data, length, out);
+    } else {
+        out.append(data, length);
+    }
+}
+
+string normalizePdfText(const string& text) {
+    // No pass makes its input longer, so two buffers cover all of them
+    string a, b;
+    a.reserve(text.length());
+    b.reserve(text.length());
+
+    joinHyphensAndCollapseSpaces(text, a);
+    removePageNumbers(a, b);
+    a.clear();
+    joinBrokenSentences(b, a);
+    b.clear();
+    stripControlsAndBlankLines(a, b);
+    trim(b, " \t\n\v\f\r");     // "^\s+|\s+$"
+    return b;
+}
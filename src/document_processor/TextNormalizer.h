@@ -0,0 +1,32 @@
+#ifndef TEXT_NORMALIZER_H
+#define TEXT_NORMALIZER_H
+
+#include <string>
+#include <cstddef>
+
+using namespace std;
+
+// Regex-free versions of the std::regex clean-ups DocumentProcessor ran over
+// whole documents. The output is byte-for-byte what the regex passes
+// produced (scripts/test_text_normalizer.sh checks this against them).
+//
+// Each pass copies the stretch up to the next byte it cares about in one
+// go; those bytes are found with a SIMD nibble-table classification (AVX2
+// where available, scalar otherwise), so plain text streams through.
+
+// cleanText: when collapseWhitespace, runs of spaces become one space, runs
+// of three or more newlines become two and carriage returns are dropped, in
+// a single pass; then " \t\n" is trimmed from both ends
+string normalizeText(const string& text, bool collapseWhitespace);
+
+// normalizeText without the trim, appended to out, for text cleaned a piece
+// at a time: a piece must not end inside a run of spaces, newlines or
+// carriage returns that continues in the next one
+void appendNormalizedText(const char* data, size_t length, bool collapseWhitespace, string& out);
+
+// cleanPdfText: joins words hyphenated across lines, collapses spaces, drops
+// bare page-number lines, joins sentences broken across column lines,
+// strips control characters, limits blank lines and trims whitespace
+string normalizePdfText(const string& text);
+
+#endif // TEXT_NORMALIZER_H
@@ -0,0 +1,468 @@
+#include "EmbeddingClient.h"
+#include <iostream>
+#include <unordered_map>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <cstring>
+#include <cmath>
+#include <sys/socket.h>
+#include <nlohmann/json.hpp>
+#include "httplib.h"
+#include "../vector_db/DistanceKernels.h"
+
+// Requires: cpp-httplib (https://github.com/yhirose/cpp-httplib)
+
+// Body of a /embed/binary response (all little-endian):
+//
+//   [BinaryEmbeddingHeader: 24 bytes]
+//   [uint32 id lengths: rows]
+//   [id bytes: id_bytes, concatenated], zero-padded to a multiple of 4
+//   [matrix: rows * dim elements of float32 or fp16, row-major]
+static const char BINARY_EMBEDDING_MAGIC[4] = {'M', 'E', 'M', 'B'};
+static const uint16_t BINARY_EMBEDDING_VERSION = 1;
+
+struct BinaryEmbeddingHeader {
+    char magic[4];          // "MEMB"
+    uint16_t version;
+    uint16_t dtype;         // 0 = float32, 1 = fp16
+    uint32_t rows;
+    uint32_t dim;
+    uint32_t id_bytes;
+    uint32_t reserved;
+};
+
+static_assert(sizeof(BinaryEmbeddingHeader) == 24, "BinaryEmbeddingHeader must stay 24 bytes");
+
+static long long steadyNowMs() {
+    return chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static inline uint64_t splitMix64(uint64_t& state) {
+    uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+// Gaussian components (Box-Muller) normalized to length 1, so mock vectors
+// are spread uniformly over the sphere like real normalized embeddings
+static void mockEmbedding(string_view text, size_t dim, float* out) {
+    ContentHash hash = hash128(text.data(), text.size());
+    uint64_t state = hash.hi ^ (hash.lo * 0x9e3779b97f4a7c15ULL);
+    const double twoPi = 6.283185307179586;
+    double norm = 0.0;
+    for (size_t d = 0; d < dim; d += 2) {
+        // 53 random bits in (0, 1]
+        double u1 = (double((splitMix64(state) >> 11) + 1)) * 0x1.0p-53;
+        double u2 = double(splitMix64(state) >> 11) * 0x1.0p-53;
+        double radius = sqrt(-2.0 * log(u1));
+        out[d] = static_cast<float>(radius * cos(twoPi * u2));
+        if (d + 1 < dim) out[d + 1] = static_cast<float>(radius * sin(twoPi * u2));
+    }
+    for (size_t d = 0; d < dim; ++d) norm += double(out[d]) * out[d];
+    float scale = norm > 0.0 ? static_cast<float>(1.0 / sqrt(norm)) : 0.0f;
+    for (size_t d = 0; d < dim; ++d) out[d] *= scale;
+}
+
+EmbeddingResponseFormat responseFormatFromString(const string& value) {
+    if (value == "float32") return EmbeddingResponseFormat::Float32;
+    if (value == "fp16") return EmbeddingResponseFormat::Fp16;
+    return EmbeddingResponseFormat::Json;
+}
+
+// Both decoders place rows by id and mark them in filled (indexed from
+// begin); the first batch fixes dim and sizes out for totalRows rows
+static bool decodeJsonEmbeddings(const string& body, const unordered_map<string_view, size_t>& rowById,
+                                 size_t begin, size_t totalRows, vector<float>& out, size_t& dim,
+                                 vector<bool>& filled) {
+    nlohmann::json resp = nlohmann::json::parse(body, nullptr, false);
+    if (resp.is_discarded() || !resp.is_array() || resp.empty()) {
+        cerr << "Embedding server returned an invalid response" << endl;
+        return false;
+    }
+
+    if (dim == 0) {
+        dim = resp[0]["embedding"].size();
+        if (dim == 0) {
+            cerr << "Embedding server returned an empty embedding" << endl;
+            return false;
+        }
+        out.assign(totalRows * dim, 0.0f);
+    }
+
+    for (const auto& item : resp) {
+        auto found = rowById.find(item.value("id", ""));
+        const nlohmann::json& values = item["embedding"];
+        if (found == rowById.end() || values.size() != dim) {
+            continue;
+        }
+        float* row = &out[found->second * dim];
+        for (size_t d = 0; d < dim; ++d) row[d] = values[d].get<float>();
+        filled[found->second - begin] = true;
+    }
+    return true;
+}
+
+static bool decodeBinaryEmbeddings(const string& body, const unordered_map<string_view, size_t>& rowById,
+                                   size_t begin, size_t totalRows, vector<float>& out, size_t& dim,
+                                   vector<bool>& filled) {
+    BinaryEmbeddingHeader header;
+    if (body.size() < sizeof(header)) {
+        cerr << "Embedding server returned a truncated binary response" << endl;
+        return false;
+    }
+    memcpy(&header, body.data(), sizeof(header));
+    size_t elementBytes = header.dtype == 1 ? sizeof(uint16_t) : sizeof(float);
+    size_t idsStart = sizeof(header) + size_t(header.rows) * sizeof(uint32_t);
+    size_t matrixStart = (idsStart + header.id_bytes + 3) / 4 * 4;
+    if (memcmp(header.magic, BINARY_EMBEDDING_MAGIC, sizeof(BINARY_EMBEDDING_MAGIC)) != 0 ||
+        header.version != BINARY_EMBEDDING_VERSION || header.dtype > 1 || header.dim == 0 ||
+        body.size() < matrixStart + size_t(header.rows) * header.dim * elementBytes) {
+        cerr << "Embedding server returned an invalid binary response" << endl;
+        return false;
+    }
+
+    if (dim == 0) {
+        dim = header.dim;
+        out.assign(totalRows * dim, 0.0f);
+    }
+    if (header.dim != dim) {
+        cerr << "Embedding server changed dimension from " << dim << " to " << header.dim << endl;
+        return false;
+    }
+
+    const char* lengths = body.data() + sizeof(header);
+    const char* matrix = body.data() + matrixStart;
+    size_t idOffset = idsStart;
+    for (size_t r = 0; r < header.rows; ++r) {
+        uint32_t idLength;
+        memcpy(&idLength, lengths + r * sizeof(uint32_t), sizeof(idLength));
+        if (idOffset + idLength > idsStart + header.id_bytes) {
+            cerr << "Embedding server returned an invalid binary response" << endl;
+            return false;
+        }
+        auto found = rowById.find(string_view(body).substr(idOffset, idLength));
+        idOffset += idLength;
+        if (found == rowById.end()) {
+            continue;
+        }
+
+        float* row = &out[found->second * dim];
+        const char* src = matrix + r * dim * elementBytes;
+        if (header.dtype == 0) {
+            memcpy(row, src, dim * sizeof(float));
+        } else {
+            for (size_t d = 0; d < dim; ++d) {
+                uint16_t half;
+                memcpy(&half, src + d * sizeof(uint16_t), sizeof(half));
+                row[d] = halfToFloat(half);
+            }
+        }
+        filled[found->second - begin] = true;
+    }
+    return true;
+}
+
+EmbeddingClient::EmbeddingClient(const EmbeddingConfig& config, const PerformanceConfig& performance,
+                                 const PathsConfig& paths)
+    : config(config),
+      serverAddress(config.unix_socket.empty() ? config.endpoint : "unix:" + config.unix_socket),
+      maxInFlight(static_cast<size_t>(max(1, min(config.max_in_flight,
+                                                 performance.parallel_processing ? performance.max_threads : 1)))),
+      responseFormat(responseFormatFromString(config.response_format)),
+      mockBackend(config.backend == "mock"),
+      queryCache(performance.enable_caching ? size_t(max(performance.cache_size_mb, 0)) << 20 : 0) {
+    // Mock vectors cost less to compute than to look up
+    if (performance.enable_caching && !mockBackend) {
+        documentCache.reset(new EmbeddingDiskCache(paths.temp_dir, config.model, config.dim,
+                                                   uint64_t(max(performance.document_cache_max_mb, 0)) << 20));
+    }
+}
+
+// Out of line so unique_ptr<httplib::Client> sees the complete type
+EmbeddingClient::~EmbeddingClient() {}
+
+unique_ptr<httplib::Client> EmbeddingClient::acquireConnection() {
+    {
+        lock_guard<mutex> lock(poolMutex);
+        if (!idleConnections.empty()) {
+            unique_ptr<httplib::Client> connection = move(idleConnections.back());
+            idleConnections.pop_back();
+            return connection;
+        }
+    }
+    unique_ptr<httplib::Client> connection;
+    if (!config.unix_socket.empty()) {
+        // A local socket skips the loopback TCP stack; the port is unused
+        connection.reset(new httplib::Client(config.unix_socket, 80));
+        connection->set_address_family(AF_UNIX);
+    } else {
+        connection.reset(new httplib::Client(config.endpoint));
+        connection->set_tcp_nodelay(true);     // Headers and body go out as separate writes
+    }
+    time_t timeout = max(config.timeout_seconds, 1);
+    connection->set_keep_alive(true);
+    connection->set_connection_timeout(timeout);
+    connection->set_read_timeout(timeout);
+    connection->set_write_timeout(timeout);
+    return connection;
+}
+
+void EmbeddingClient::releaseConnection(unique_ptr<httplib::Client> connection, bool healthy) {
+    if (!healthy) {
+        return;
+    }
+    lock_guard<mutex> lock(poolMutex);
+    idleConnections.push_back(move(connection));
+}
+
+bool EmbeddingClient::embedDocuments(const vector<string_view>& texts, const vector<string>& ids,
+                                     vector<float>& out, size_t& dim, size_t* cachedCount) {
+    if (cachedCount) *cachedCount = 0;
+    if (!documentCache) {
+        return requestEmbeddings(texts, ids, out, dim);
+    }
+
+    // Look every text up first; only the misses go to the server
+    vector<ContentHash> keys(texts.size());
+    vector<vector<float>> cached(texts.size());
+    vector<string_view> missTexts;
+    vector<string> missIds;
+    vector<size_t> missRows;
+    size_t cachedDim = 0;
+    bool dimsAgree = true;
+    for (size_t i = 0; i < texts.size(); ++i) {
+        keys[i] = documentCache->keyFor(texts[i]);
+        if (documentCache->get(keys[i], cached[i])) {
+            if (cachedDim == 0) cachedDim = cached[i].size();
+            dimsAgree = dimsAgree && cached[i].size() == cachedDim;
+        } else {
+            cached[i].clear();
+            missTexts.push_back(texts[i]);
+            missIds.push_back(ids[i]);
+            missRows.push_back(i);
+        }
+    }
+
+    // Cache each batch as it lands, so a failure part-way keeps the work done
+    mutex cacheMutex;
+    vector<float> fetched;
+    size_t fetchedDim = 0;
+    size_t persisted = 0;
+    auto persistBatch = [&](size_t begin, size_t end) {
+        lock_guard<mutex> lock(cacheMutex);
+        size_t rowDim = fetched.size() / missTexts.size();
+        for (size_t m = begin; m < end; ++m) {
+            documentCache->put(keys[missRows[m]], &fetched[m * rowDim], rowDim);
+        }
+        persisted += end - begin;
+    };
+    if (!requestEmbeddings(missTexts, missIds, fetched, fetchedDim, persistBatch)) {
+        if (persisted > 0) {
+            cout << "⚠️  " << persisted << " of " << missTexts.size()
+                 << " new chunks were embedded and cached; adding the document again resumes from there.\n";
+        }
+        return false;
+    }
+    // The server no longer agrees with what was cached for this model: trust the server
+    if (!dimsAgree || (fetchedDim != 0 && cachedDim != 0 && fetchedDim != cachedDim)) {
+        return requestEmbeddings(texts, ids, out, dim);
+    }
+
+    dim = fetchedDim != 0 ? fetchedDim : cachedDim;
+    out.assign(texts.size() * dim, 0.0f);
+    for (size_t i = 0; i < texts.size(); ++i) {
+        if (!cached[i].empty()) {
+            copy(cached[i].begin(), cached[i].end(), &out[i * dim]);
+        }
+    }
+    for (size_t m = 0; m < missRows.size(); ++m) {
+        const float* row = &fetched[m * dim];
+        copy(row, row + dim, &out[missRows[m] * dim]);
+    }
+    if (cachedCount) *cachedCount = texts.size() - missRows.size();
+    return true;
+}
+
+bool EmbeddingClient::requestEmbeddings(const vector<string_view>& texts, const vector<string>& ids,
+                                        vector<float>& out, size_t& dim, const BatchDone& onBatch) {
+    out.clear();
+    dim = 0;
+    if (texts.empty()) {
+        return true;
+    }
+
+    if (mockBackend) {
+        dim = static_cast<size_t>(max(config.dim, 1));
+        out.resize(texts.size() * dim);
+        for (size_t i = 0; i < texts.size(); ++i) {
+            mockEmbedding(texts[i], dim, &out[i * dim]);
+        }
+        if (onBatch) onBatch(0, texts.size());
+        return true;
+    }
+
+    // embedding.batch_size texts per request keeps each JSON body and model
+    // call small; rows are written into out as each batch returns
+    size_t batchSize = config.batch_size > 0 ? static_cast<size_t>(config.batch_size) : texts.size();
+    size_t batches = (texts.size() + batchSize - 1) / batchSize;
+
+    // The first batch fixes the dimension and sizes out, so the rest can
+    // write their disjoint row ranges in place
+    unique_ptr<httplib::Client> first = acquireConnection();
+    size_t firstEnd = min(batchSize, texts.size());
+    bool firstOk = requestBatch(*first, texts, ids, 0, firstEnd, out, dim);
+    releaseConnection(move(first), firstOk);
+    if (!firstOk) {
+        out.clear();
+        dim = 0;
+        return false;
+    }
+    if (onBatch) onBatch(0, firstEnd);
+
+    // Each worker keeps one request in flight and encodes / parses its own
+    // batches while the server runs the others; taking the next batch only
+    // after finishing one is the back-pressure
+    atomic<size_t> nextBatch(1);
+    atomic<bool> failed(false);
+    auto worker = [&]() {
+        unique_ptr<httplib::Client> connection = acquireConnection();
+        bool healthy = true;
+        size_t batchDim = dim;
+        for (size_t b = nextBatch++; b < batches && !failed; b = nextBatch++) {
+            size_t begin = b * batchSize;
+            size_t end = min(begin + batchSize, texts.size());
+            if (!requestBatch(*connection, texts, ids, begin, end, out, batchDim)) {
+                healthy = false;
+                failed = true;
+            } else if (onBatch) {
+                onBatch(begin, end);
+            }
+        }
+        releaseConnection(move(connection), healthy);
+    };
+
+    size_t workers = min(maxInFlight, batches - 1);
+    vector<thread> threads;
+    for (size_t w = 1; w < workers; ++w) {
+        threads.emplace_back(worker);
+    }
+    if (workers > 0) {
+        worker();
+    }
+    for (thread& t : threads) {
+        t.join();
+    }
+
+    if (failed) {
+        out.clear();
+        dim = 0;
+        return false;
+    }
+    return true;
+}
+
+bool EmbeddingClient::requestBatch(httplib::Client& cli, const vector<string_view>& texts,
+                                   const vector<string>& ids, size_t begin, size_t end,
+                                   vector<float>& out, size_t& dim) {
+    bool binary = responseFormat != EmbeddingResponseFormat::Json;
+    nlohmann::json req;
+    req["texts"] = vector<string>(texts.begin() + begin, texts.begin() + end);
+    req["ids"] = vector<string>(ids.begin() + begin, ids.begin() + end);
+    if (binary) {
+        req["dtype"] = responseFormat == EmbeddingResponseFormat::Fp16 ? "fp16" : "float32";
+    }
+    string body = req.dump();
+    const char* path = binary ? "/embed/binary" : "/embed";
+
+    httplib::Result res;
+    for (int attempt = 0; ; ++attempt) {
+        if (!serverAvailable()) {
+            cerr << "Embedding server " << serverAddress
+                 << " is marked down after repeated failures; not sending" << endl;
+            return false;
+        }
+        res = cli.Post(path, body, "application/json");
+        if (res && res->status == 200) {
+            recordSuccess();
+            break;
+        }
+
+        // Only unreachable or overloaded servers are worth another try
+        string reason = res ? "HTTP " + to_string(res->status) : httplib::to_string(res.error());
+        bool transient = !res || res->status >= 500 || res->status == 429;
+        if (transient) {
+            recordFailure();
+        }
+        if (!transient || attempt >= config.max_retries) {
+            cerr << "Failed to get embeddings from " << serverAddress << ": " << reason << endl;
+            return false;
+        }
+        long long delayMs = static_cast<long long>(max(config.retry_backoff_ms, 0)) << min(attempt, 10);
+        cerr << "⚠️  " << reason << " from " << serverAddress << ", retrying in " << delayMs
+             << " ms (" << attempt + 1 << "/" << config.max_retries << ")" << endl;
+        this_thread::sleep_for(chrono::milliseconds(delayMs));
+    }
+
+    // Results may come back in any order; place each by its id
+    unordered_map<string_view, size_t> rowById;  // Views of ids, which outlive the request
+    for (size_t i = begin; i < end; ++i) {
+        rowById[ids[i]] = i;
+    }
+    vector<bool> filled(end - begin, false);
+    bool decoded = binary ? decodeBinaryEmbeddings(res->body, rowById, begin, texts.size(), out, dim, filled)
+                          : decodeJsonEmbeddings(res->body, rowById, begin, texts.size(), out, dim, filled);
+    if (!decoded) {
+        return false;
+    }
+
+    size_t missing = count(filled.begin(), filled.end(), false);
+    if (missing > 0) {
+        cerr << "Embedding server returned no usable embedding for " << missing
+             << " of " << (end - begin) << " texts" << endl;
+        return false;
+    }
+    return true;
+}
+
+bool EmbeddingClient::serverAvailable() {
+    long long openUntil = breakerOpenUntilMs;
+    // Once the cooldown ends, requests probe the server again
+    return openUntil == 0 || steadyNowMs() >= openUntil;
+}
+
+void EmbeddingClient::recordSuccess() {
+    consecutiveFailures = 0;
+    breakerOpenUntilMs = 0;
+}
+
+void EmbeddingClient::recordFailure() {
+    int failures = ++consecutiveFailures;
+    if (config.breaker_failures <= 0 || failures < config.breaker_failures) {
+        return;
+    }
+    long long openUntil = steadyNowMs() + 1000LL * max(config.breaker_cooldown_seconds, 0);
+    if (breakerOpenUntilMs.exchange(openUntil) == 0) {
+        cerr << "🔌 Embedding server " << serverAddress << " failed " << failures
+             << " times in a row; failing fast for " << config.breaker_cooldown_seconds << " s" << endl;
+    }
+}
+
+bool EmbeddingClient::embedQuery(const string& question, vector<float>& out, bool* cacheHit) {
+    string key = QueryEmbeddingCache::normalize(question);
+    bool hit = queryCache.get(key, out);
+    if (cacheHit) *cacheHit = hit;
+    if (hit) {
+        return true;
+    }
+
+    size_t dim = 0;
+    string prefixed = config.query_prefix + question;
+    if (!requestEmbeddings({prefixed}, {"query"}, out, dim)) {
+        return false;
+    }
+    queryCache.put(key, out);
+    return true;
+}
@@ -0,0 +1,119 @@
+#ifndef EMBEDDING_CLIENT_H
+#define EMBEDDING_CLIENT_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include "../config/ConfigManager.h"
+#include "QueryEmbeddingCache.h"
+#include "EmbeddingDiskCache.h"
+
+using namespace std;
+
+namespace httplib {
+class Client;
+}
+
+// Client for the embedding server (embedding_server.py, POST /embed at
+// embedding.endpoint, or over embedding.unix_socket when set). Embeddings
+// come back as one row-major matrix in request order, so callers copy rows
+// straight into the index instead of one vector per text.
+//
+// With embedding.response_format float32 or fp16 the client calls
+// /embed/binary instead, which answers with a little-endian matrix
+// (layout in EmbeddingClient.cpp) copied straight into the result rows.
+//
+// One client lives as long as its session manager and keeps a pool of
+// keep-alive connections, one per concurrent batch, so consecutive requests
+// and documents reuse open sockets instead of reconnecting.
+//
+// With embedding.backend mock no server is involved: every text maps to a
+// pseudo-random unit vector of embedding.dim seeded by its content hash, so
+// runs are reproducible and chunking, storage and search can be benchmarked
+// at any scale without a model.
+//
+// Transient failures (no connection, 5xx, 429) are retried per batch with
+// exponential backoff. After embedding.breaker_failures consecutive failures
+// the server is treated as down and requests fail immediately until the
+// cooldown ends. Each batch is written to the document cache as soon as it
+// arrives, so adding a document again after a failure only sends the
+// batches that did not make it.
+
+// How /embed answers (embedding.response_format)
+enum class EmbeddingResponseFormat {
+    Json,           // [{"id": ..., "embedding": [floats]}]
+    Float32,        // Binary matrix of float32
+    Fp16            // Binary matrix of IEEE half, half the bytes on the wire
+};
+
+EmbeddingResponseFormat responseFormatFromString(const string& value);
+
+class EmbeddingClient {
+public:
+    // performance.enable_caching turns on the query cache (cache_size_mb)
+    // and the document cache under paths.temp_dir (document_cache_max_mb);
+    // performance.max_threads (or 1 without parallel_processing) caps
+    // embedding.max_in_flight
+    EmbeddingClient(const EmbeddingConfig& config, const PerformanceConfig& performance,
+                    const PathsConfig& paths);
+    ~EmbeddingClient();
+
+    EmbeddingClient(const EmbeddingClient&) = delete;
+    EmbeddingClient& operator=(const EmbeddingClient&) = delete;
+
+    // Row i of out (dim floats) is the embedding of texts[i], sent as ids[i];
+    // the texts only need to live until this returns. Texts already in the
+    // document cache are not sent; cachedCount, if given, receives how many
+    // rows came from it
+    bool embedDocuments(const vector<string_view>& texts, const vector<string>& ids,
+                        vector<float>& out, size_t& dim, size_t* cachedCount = nullptr);
+
+    // Embeds a question with embedding.query_prefix prepended; answered from
+    // the query cache when the normalized question was embedded before
+    bool embedQuery(const string& question, vector<float>& out, bool* cacheHit = nullptr);
+
+    const QueryEmbeddingCache& getQueryCache() const { return queryCache; }
+
+private:
+    EmbeddingConfig config;
+    string serverAddress;       // endpoint or unix:<socket>, for messages
+    size_t maxInFlight;         // Batches sent concurrently, at least 1
+    EmbeddingResponseFormat responseFormat;
+    bool mockBackend;
+    QueryEmbeddingCache queryCache;
+    unique_ptr<EmbeddingDiskCache> documentCache;  // nullptr when caching is off
+
+    atomic<int> consecutiveFailures{0};
+    atomic<long long> breakerOpenUntilMs{0};   // steady_clock ms; 0 when closed
+
+    mutex poolMutex;
+    vector<unique_ptr<httplib::Client>> idleConnections;
+
+    // Takes an idle connection or opens a new one
+    unique_ptr<httplib::Client> acquireConnection();
+    // Returns a connection to the pool; broken ones are dropped instead
+    void releaseConnection(unique_ptr<httplib::Client> connection, bool healthy);
+
+    // Called with [begin, end) once those rows of out are final
+    typedef function<void(size_t begin, size_t end)> BatchDone;
+
+    // POST /embed in embedding.batch_size batches, up to maxInFlight at a
+    // time, no caching
+    bool requestEmbeddings(const vector<string_view>& texts, const vector<string>& ids,
+                           vector<float>& out, size_t& dim, const BatchDone& onBatch = nullptr);
+    // Sends texts[begin, end), retrying transient failures, and fills those rows of out
+    bool requestBatch(httplib::Client& cli, const vector<string_view>& texts,
+                      const vector<string>& ids, size_t begin, size_t end,
+                      vector<float>& out, size_t& dim);
+
+    // Circuit breaker: whether a request may go out now, and its outcome
+    bool serverAvailable();
+    void recordSuccess();
+    void recordFailure();
+};
+
+#endif // EMBEDDING_CLIENT_H
@@ -0,0 +1,336 @@
+#include "EmbeddingDiskCache.h"
+#include <iostream>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/file.h>
+
+static const char CACHE_MAGIC[8] = {'M', 'I', 'M', 'I', 'R', 'E', 'C', 'H'};
+static const uint32_t CACHE_FILE_VERSION = 1;
+
+struct CacheFileHeader {
+    char magic[8];          // "MIMIRECH"
+    uint32_t version;
+    uint32_t reserved;
+};
+
+struct CacheRecordHeader {
+    uint64_t hi;
+    uint64_t lo;
+    uint32_t dim;
+    uint32_t reserved;
+};
+
+static_assert(sizeof(CacheFileHeader) == 16, "CacheFileHeader must stay 16 bytes");
+static_assert(sizeof(CacheRecordHeader) == 24, "CacheRecordHeader must stay 24 bytes");
+
+static inline uint64_t rotl64(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t fmix64(uint64_t k) {
+    k ^= k >> 33;
+    k *= 0xff51afd7ed558ccdULL;
+    k ^= k >> 33;
+    k *= 0xc4ceb9fe1a85ec53ULL;
+    k ^= k >> 33;
+    return k;
+}
+
+ContentHash hash128(const void* data, size_t length, uint64_t seed) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    const size_t blocks = length / 16;
+    const uint64_t c1 = 0x87c37b91114253d5ULL;
+    const uint64_t c2 = 0x4cf5ad432745937fULL;
+    uint64_t h1 = seed;
+    uint64_t h2 = seed;
+
+    for (size_t i = 0; i < blocks; ++i) {
+        uint64_t k1, k2;
+        memcpy(&k1, bytes + i * 16, 8);
+        memcpy(&k2, bytes + i * 16 + 8, 8);
+
+        k1 *= c1; k1 = rotl64(k1, 31); k1 *= c2; h1 ^= k1;
+        h1 = rotl64(h1, 27); h1 += h2; h1 = h1 * 5 + 0x52dce729;
+        k2 *= c2; k2 = rotl64(k2, 33); k2 *= c1; h2 ^= k2;
+        h2 = rotl64(h2, 31); h2 += h1; h2 = h2 * 5 + 0x38495ab5;
+    }
+
+    const uint8_t* tail = bytes + blocks * 16;
+    uint64_t k1 = 0;
+    uint64_t k2 = 0;
+    switch (length & 15) {
+        case 15: k2 ^= uint64_t(tail[14]) << 48; // fallthrough
+        case 14: k2 ^= uint64_t(tail[13]) << 40; // fallthrough
+        case 13: k2 ^= uint64_t(tail[12]) << 32; // fallthrough
+        case 12: k2 ^= uint64_t(tail[11]) << 24; // fallthrough
+        case 11: k2 ^= uint64_t(tail[10]) << 16; // fallthrough
+        case 10: k2 ^= uint64_t(tail[9]) << 8;   // fallthrough
+        case 9:
+            k2 ^= uint64_t(tail[8]);
+            k2 *= c2; k2 = rotl64(k2, 33); k2 *= c1; h2 ^= k2;
+            // fallthrough
+        case 8: k1 ^= uint64_t(tail[7]) << 56;   // fallthrough
+        case 7: k1 ^= uint64_t(tail[6]) << 48;   // fallthrough
+        case 6: k1 ^= uint64_t(tail[5]) << 40;   // fallthrough
+        case 5: k1 ^= uint64_t(tail[4]) << 32;   // fallthrough
+        case 4: k1 ^= uint64_t(tail[3]) << 24;   // fallthrough
+        case 3: k1 ^= uint64_t(tail[2]) << 16;   // fallthrough
+        case 2: k1 ^= uint64_t(tail[1]) << 8;    // fallthrough
+        case 1:
+            k1 ^= uint64_t(tail[0]);
+            k1 *= c1; k1 = rotl64(k1, 31); k1 *= c2; h1 ^= k1;
+    }
+
+    h1 ^= length;
+    h2 ^= length;
+    h1 += h2;
+    h2 += h1;
+    h1 = fmix64(h1);
+    h2 = fmix64(h2);
+    h1 += h2;
+    h2 += h1;
+
+    ContentHash result;
+    result.hi = h1;
+    result.lo = h2;
+    return result;
+}
+
+// mkdir -p
+static bool makeDirectories(const string& path) {
+    struct stat info;
+    if (path.empty() || stat(path.c_str(), &info) == 0) {
+        return true;
+    }
+    size_t slash = path.find_last_of('/');
+    if (slash != string::npos && slash > 0 && !makeDirectories(path.substr(0, slash))) {
+        return false;
+    }
+    return mkdir(path.c_str(), 0755) == 0 || errno == EEXIST;
+}
+
+EmbeddingDiskCache::EmbeddingDiskCache(const string& directory, const string& model, int dim, uint64_t maxBytes)
+    : directory(directory), model(model), dim(dim), maxBytes(maxBytes) {}
+
+EmbeddingDiskCache::~EmbeddingDiskCache() {
+    if (fd >= 0) {
+        close(fd);
+    }
+}
+
+ContentHash EmbeddingDiskCache::keyFor(string_view text) const {
+    // NUL separators keep ("ab", "c") and ("a", "bc") apart
+    string material = model;
+    material += '\0';
+    material += to_string(dim);
+    material += '\0';
+    material += text;
+    return hash128(material.data(), material.size());
+}
+
+// Opens path and takes the exclusive lock, retrying if another process
+// renamed a compacted file over it meanwhile; -1 on failure
+static int openLocked(const string& path) {
+    for (;;) {
+        int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_APPEND, 0644);
+        if (fd < 0) {
+            return -1;
+        }
+        struct stat opened, current;
+        if (flock(fd, LOCK_EX) != 0 || fstat(fd, &opened) != 0) {
+            close(fd);
+            return -1;
+        }
+        if (stat(path.c_str(), &current) == 0 && current.st_ino == opened.st_ino &&
+            current.st_dev == opened.st_dev) {
+            return fd;
+        }
+        close(fd);
+    }
+}
+
+bool EmbeddingDiskCache::open() {
+    if (fd >= 0) {
+        return true;
+    }
+    if (openFailed) {
+        return false;
+    }
+
+    string filePath = directory + "/embedding_cache.bin";
+    if (!makeDirectories(directory) || (fd = openLocked(filePath)) < 0) {
+        cout << "⚠️  Embedding cache unavailable at " << filePath << ", embedding without it.\n";
+        openFailed = true;
+        return false;
+    }
+
+    // Under the lock no other process is half way through an append, so
+    // anything incomplete at the end was left by a crash
+    auto fail = [this]() {
+        close(fd);
+        fd = -1;
+        openFailed = true;
+        return false;
+    };
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        return fail();
+    }
+    uint64_t fileSize = static_cast<uint64_t>(info.st_size);
+
+    CacheFileHeader header;
+    if (fileSize < sizeof(header)) {
+        // New (or torn before the header was complete): start over
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+        header.version = CACHE_FILE_VERSION;
+        if (ftruncate(fd, 0) != 0 ||
+            write(fd, &header, sizeof(header)) != static_cast<ssize_t>(sizeof(header))) {
+            return fail();
+        }
+        flock(fd, LOCK_UN);
+        return true;
+    }
+
+    if (pread(fd, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header)) ||
+        memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 ||
+        header.version != CACHE_FILE_VERSION) {
+        cout << "⚠️  " << filePath << " is not an embedding cache, embedding without it.\n";
+        return fail();
+    }
+
+    uint64_t end = scanRecords(fileSize);
+    if (end < fileSize && ftruncate(fd, end) != 0) {
+        // Appending after the torn record would hide every later one
+        cout << "⚠️  Could not trim a partial record from " << filePath << ", embedding without the cache.\n";
+        return fail();
+    }
+    if (maxBytes > 0 && end > maxBytes && !compact(filePath, end)) {
+        cout << "⚠️  Could not compact " << filePath << ", embedding without the cache.\n";
+        return fail();
+    }
+    flock(fd, LOCK_UN);
+    return true;
+}
+
+uint64_t EmbeddingDiskCache::scanRecords(uint64_t fileSize) {
+    // Index every complete record; later duplicates of a key win
+    offsets.clear();
+    uint64_t offset = sizeof(CacheFileHeader);
+    CacheRecordHeader record;
+    while (offset + sizeof(record) <= fileSize &&
+           pread(fd, &record, sizeof(record), offset) == static_cast<ssize_t>(sizeof(record))) {
+        uint64_t end = offset + sizeof(record) + uint64_t(record.dim) * sizeof(float);
+        if (record.dim == 0 || end > fileSize) {
+            break;
+        }
+        ContentHash key;
+        key.hi = record.hi;
+        key.lo = record.lo;
+        offsets[key] = Location{offset + sizeof(record), record.dim};
+        offset = end;
+    }
+    return offset;
+}
+
+bool EmbeddingDiskCache::compact(const string& filePath, uint64_t fileSize) {
+    // Records are appended in time order: keep the longest suffix of them
+    // that fits in half the cap
+    vector<uint64_t> recordStarts;
+    uint64_t offset = sizeof(CacheFileHeader);
+    CacheRecordHeader record;
+    while (offset < fileSize &&
+           pread(fd, &record, sizeof(record), offset) == static_cast<ssize_t>(sizeof(record))) {
+        recordStarts.push_back(offset);
+        offset += sizeof(record) + uint64_t(record.dim) * sizeof(float);
+    }
+    uint64_t budget = maxBytes / 2;
+    size_t first = recordStarts.size();
+    while (first > 0 && fileSize - recordStarts[first - 1] <= budget) {
+        --first;
+    }
+    uint64_t keepFrom = first < recordStarts.size() ? recordStarts[first] : fileSize;
+
+    string tempPath = filePath + ".tmp";
+    int out = ::open(tempPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (out < 0) {
+        return false;
+    }
+    vector<char> buffer(1 << 20);
+    bool copied = pread(fd, buffer.data(), sizeof(CacheFileHeader), 0) ==
+                      static_cast<ssize_t>(sizeof(CacheFileHeader)) &&
+                  write(out, buffer.data(), sizeof(CacheFileHeader)) ==
+                      static_cast<ssize_t>(sizeof(CacheFileHeader));
+    for (uint64_t at = keepFrom; copied && at < fileSize; ) {
+        size_t length = static_cast<size_t>(min<uint64_t>(buffer.size(), fileSize - at));
+        copied = pread(fd, buffer.data(), length, at) == static_cast<ssize_t>(length) &&
+                 write(out, buffer.data(), length) == static_cast<ssize_t>(length);
+        at += length;
+    }
+    copied = copied && fsync(out) == 0;
+    close(out);
+    if (!copied || rename(tempPath.c_str(), filePath.c_str()) != 0) {
+        unlink(tempPath.c_str());
+        return false;
+    }
+
+    // The lock on the old file goes with it; the new one is only reachable
+    // once complete, so nothing else is writing to it yet
+    close(fd);
+    fd = ::open(filePath.c_str(), O_RDWR | O_APPEND);
+    if (fd < 0) {
+        return false;
+    }
+    cout << "🧹 Compacted the embedding cache to its newest " << recordStarts.size() - first << " of "
+         << recordStarts.size() << " vectors\n";
+    scanRecords(sizeof(CacheFileHeader) + (fileSize - keepFrom));
+    return true;
+}
+
+bool EmbeddingDiskCache::get(const ContentHash& key, vector<float>& out) {
+    if (!open()) {
+        return false;
+    }
+    auto found = offsets.find(key);
+    if (found == offsets.end()) {
+        return false;
+    }
+    out.resize(found->second.dim);
+    ssize_t bytes = static_cast<ssize_t>(out.size() * sizeof(float));
+    return pread(fd, out.data(), bytes, found->second.offset) == bytes;
+}
+
+bool EmbeddingDiskCache::put(const ContentHash& key, const float* vec, size_t vecDim) {
+    if (vecDim == 0 || !open()) {
+        return false;
+    }
+    if (offsets.count(key)) {
+        return true;
+    }
+
+    CacheRecordHeader record = {};
+    record.hi = key.hi;
+    record.lo = key.lo;
+    record.dim = static_cast<uint32_t>(vecDim);
+    vector<char> buffer(sizeof(record) + vecDim * sizeof(float));
+    memcpy(buffer.data(), &record, sizeof(record));
+    memcpy(buffer.data() + sizeof(record), vec, vecDim * sizeof(float));
+
+    // O_APPEND writes land at the current end even if another process
+    // appended meanwhile, and leave the file offset just past this record.
+    // The lock keeps an opening process from taking it for a torn one
+    if (flock(fd, LOCK_EX) != 0) {
+        return false;
+    }
+    bool written = write(fd, buffer.data(), buffer.size()) == static_cast<ssize_t>(buffer.size());
+    off_t end = written ? lseek(fd, 0, SEEK_CUR) : -1;
+    flock(fd, LOCK_UN);
+    if (end < 0) {
+        return false;
+    }
+    offsets[key] = Location{static_cast<uint64_t>(end) - vecDim * sizeof(float), record.dim};
+    return true;
+}
@@ -0,0 +1,90 @@
+#ifndef EMBEDDING_DISK_CACHE_H
+#define EMBEDDING_DISK_CACHE_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <cstddef>
+
+using namespace std;
+
+// 128-bit content key of one text under one embedding model
+struct ContentHash {
+    uint64_t hi = 0;
+    uint64_t lo = 0;
+
+    bool operator==(const ContentHash& other) const { return hi == other.hi && lo == other.lo; }
+};
+
+struct ContentHashHasher {
+    size_t operator()(const ContentHash& key) const { return static_cast<size_t>(key.lo); }
+};
+
+// Persistent content-addressed store of document embeddings, shared by all
+// sessions. Keys hash model + dim + text, so the same chunk text is embedded
+// once no matter which session or run ingests it; changing the model or
+// dimension simply stops matching old entries.
+//
+// Kept as one append-only file, <directory>/embedding_cache.bin:
+//
+//   [16-byte header: "MIMIRECH", uint32 version, uint32 reserved]
+//   [records: uint64 hi, uint64 lo, uint32 dim, uint32 reserved, float[dim]]
+//
+// Opening scans the record headers into an in-memory hash -> offset map;
+// vectors are read with pread() on lookup. Several processes may share the
+// file: each record is appended with a single write() on an O_APPEND
+// descriptor under an exclusive flock(), and opening takes the same lock
+// before it cuts off a torn record (left by a crashed writer, never one
+// still being written) or compacts the file.
+//
+// The file is capped at maxBytes (performance.document_cache_max_mb; 0 is
+// unbounded). Once an open finds it over the cap, only the newest records
+// filling half the cap are kept, rewritten to a new file renamed over the
+// old one. Processes that still have the old file open keep reading it and
+// their later appends to it are lost, which for a cache only costs a
+// re-embed.
+class EmbeddingDiskCache {
+public:
+    EmbeddingDiskCache(const string& directory, const string& model, int dim, uint64_t maxBytes = 0);
+    ~EmbeddingDiskCache();
+
+    EmbeddingDiskCache(const EmbeddingDiskCache&) = delete;
+    EmbeddingDiskCache& operator=(const EmbeddingDiskCache&) = delete;
+
+    ContentHash keyFor(string_view text) const;
+
+    // Both open the file on first use; false if it cannot be opened
+    bool get(const ContentHash& key, vector<float>& out);
+    bool put(const ContentHash& key, const float* vec, size_t vecDim);
+
+    size_t size() const { return offsets.size(); }
+
+private:
+    struct Location {
+        uint64_t offset;    // Of the record's floats
+        uint32_t dim;
+    };
+
+    string directory;
+    string model;
+    int dim;
+    uint64_t maxBytes;
+    int fd = -1;
+    bool openFailed = false;
+    unordered_map<ContentHash, Location, ContentHashHasher> offsets;
+
+    bool open();
+    // With the lock held: indexes the complete records of a valid file and
+    // returns where they end
+    uint64_t scanRecords(uint64_t fileSize);
+    // With the lock held: replaces the file with its newest records that fit
+    // in half of maxBytes, and switches fd to it
+    bool compact(const string& filePath, uint64_t fileSize);
+};
+
+// MurmurHash3 x64 128-bit
+ContentHash hash128(const void* data, size_t length, uint64_t seed = 0);
+
+#endif // EMBEDDING_DISK_CACHE_H
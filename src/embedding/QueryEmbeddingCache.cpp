@@ -0,0 +1,80 @@
+#include "QueryEmbeddingCache.h"
+#include <cctype>
+
+QueryEmbeddingCache::QueryEmbeddingCache(size_t maxBytes)
+    : maxBytes(maxBytes) {}
+
+string QueryEmbeddingCache::normalize(const string& text) {
+    string key;
+    key.reserve(text.size());
+    bool pendingSpace = false;
+    for (char c : text) {
+        unsigned char u = static_cast<unsigned char>(c);
+        if (isspace(u)) {
+            pendingSpace = !key.empty();
+            continue;
+        }
+        if (pendingSpace) {
+            key += ' ';
+            pendingSpace = false;
+        }
+        key += static_cast<char>(tolower(u));
+    }
+    while (!key.empty() && (key.back() == '?' || key.back() == '.' || key.back() == '!')) {
+        key.pop_back();
+    }
+    while (!key.empty() && key.back() == ' ') {
+        key.pop_back();
+    }
+    return key;
+}
+
+// Key and values plus a rough allowance for the list node and hash entry
+size_t QueryEmbeddingCache::entryBytes(const string& key, size_t floats) {
+    return key.size() + floats * sizeof(float) + 96;
+}
+
+bool QueryEmbeddingCache::get(const string& key, vector<float>& out) {
+    if (!enabled()) {
+        return false;
+    }
+    auto it = byKey.find(key);
+    if (it == byKey.end()) {
+        ++missCount;
+        return false;
+    }
+    entries.splice(entries.begin(), entries, it->second);
+    out = it->second->second;
+    ++hitCount;
+    return true;
+}
+
+void QueryEmbeddingCache::put(const string& key, const vector<float>& embedding) {
+    size_t needed = entryBytes(key, embedding.size());
+    if (!enabled() || needed > maxBytes) {
+        return;
+    }
+    auto it = byKey.find(key);
+    if (it != byKey.end()) {
+        usedBytes -= entryBytes(key, it->second->second.size());
+        entries.erase(it->second);
+        byKey.erase(it);
+    }
+
+    // Evict least recently used entries until the new one fits
+    while (usedBytes + needed > maxBytes && !entries.empty()) {
+        const Entry& oldest = entries.back();
+        usedBytes -= entryBytes(oldest.first, oldest.second.size());
+        byKey.erase(oldest.first);
+        entries.pop_back();
+    }
+    entries.emplace_front(key, embedding);
+    byKey[key] = entries.begin();
+    usedBytes += needed;
+}
+
+void QueryEmbeddingCache::clear() {
+    entries.clear();
+    byKey.clear();
+    usedBytes = 0;
+}
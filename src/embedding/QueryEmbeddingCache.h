@@ -0,0 +1,50 @@
+#ifndef QUERY_EMBEDDING_CACHE_H
+#define QUERY_EMBEDDING_CACHE_H
+
+#include <string>
+#include <vector>
+#include <list>
+#include <unordered_map>
+
+using namespace std;
+
+// Size-bounded LRU map from normalized question text to its embedding, so
+// repeated questions skip the embedding server. A budget of 0 disables it.
+class QueryEmbeddingCache {
+public:
+    explicit QueryEmbeddingCache(size_t maxBytes = 0);
+
+    // byKey holds iterators into entries, so copies would alias the original
+    QueryEmbeddingCache(const QueryEmbeddingCache&) = delete;
+    QueryEmbeddingCache& operator=(const QueryEmbeddingCache&) = delete;
+
+    // Lowercases, trims, collapses whitespace runs and drops trailing
+    // punctuation, so "What is X?" and "what is  x" share an entry
+    static string normalize(const string& text);
+
+    // Both take an already normalized key
+    bool get(const string& key, vector<float>& out);
+    void put(const string& key, const vector<float>& embedding);
+
+    void clear();
+
+    bool enabled() const { return maxBytes > 0; }
+    size_t size() const { return entries.size(); }
+    size_t bytes() const { return usedBytes; }
+    size_t hits() const { return hitCount; }
+    size_t misses() const { return missCount; }
+
+private:
+    typedef pair<string, vector<float>> Entry;
+
+    size_t maxBytes;
+    size_t usedBytes = 0;
+    size_t hitCount = 0;
+    size_t missCount = 0;
+    list<Entry> entries;                                    // Most recently used first
+    unordered_map<string, list<Entry>::iterator> byKey;
+
+    static size_t entryBytes(const string& key, size_t floats);
+};
+
+#endif // QUERY_EMBEDDING_CACHE_H
@@ -3,6 +3,8 @@
 #include <vector>
 #include <sstream>
 #include <regex>
+#include <iomanip>
+#include <algorithm>
 #include "session/SessionManager.h"
 #include "config/ConfigManager.h"
 
@@ -51,6 +53,7 @@ public:
         cout << "  delete <session_name>   - Delete a session\n";
         cout << "  add-doc <file_path>     - Add document to current session\n";
         cout << "  query <question>        - Query documents in current session\n";
+        cout << "  reindex                 - Embed chunks missing from the session's index\n";
         cout << "  list                    - List all sessions\n";
         cout << "  info                    - Show current session info\n";
         cout << "  export <session_name>   - Export session data\n";
@@ -173,13 +176,49 @@ public:
             }
             string question;
             for (size_t i = 1; i < tokens.size(); ++i) {
-                question += tokens[i] + " ";
+                if (i > 1) question += " ";
+                question += tokens[i];
             }
             
-            // TODO: Implement actual query processing
-            string answer = "This is a placeholder response for: " + question;
-            sessionManager.addChatMessage(question, answer);
-            cout << "💡 " << answer << "\n";
+            vector<RetrievedChunk> retrieved;
+            QueryTiming timing;
+            if (!sessionManager.queryChunks(question, retrieved, timing)) {
+                return;
+            }
+            
+            // No answer generation yet: report the context an LLM would get
+            const ChatConfig& chatConfig = ConfigManager::getInstance().getChatConfig();
+            vector<string> sourceChunks;
+            streamsize oldPrecision = cout.precision();
+            if (retrieved.empty()) {
+                cout << "🔎 No chunks with similarity >= " << chatConfig.similarity_threshold << "\n";
+            } else {
+                cout << "🔎 Retrieved " << retrieved.size() << " chunk(s):\n";
+            }
+            for (size_t i = 0; i < retrieved.size(); ++i) {
+                const RetrievedChunk& hit = retrieved[i];
+                sourceChunks.push_back(hit.chunk_id);
+                cout << "  " << (i + 1) << ". [" << fixed << setprecision(3) << hit.similarity << "] ";
+                if (hit.chunk) {
+                    string preview = hit.chunk->content.substr(0, 100);
+                    replace(preview.begin(), preview.end(), '\n', ' ');
+                    cout << hit.chunk->source_file << " #" << hit.chunk->chunk_index << ": " << preview
+                         << (hit.chunk->content.size() > 100 ? "..." : "") << "\n";
+                } else {
+                    cout << hit.chunk_id << "\n";
+                }
+            }
+            cout << fixed << setprecision(3) << "⏱️  embed " << timing.embed_ms
+                 << (timing.embedding_cached ? " ms (cached)" : " ms") << " | search " << timing.search_ms
+                 << " ms | filter " << timing.filter_ms << " ms | total " << timing.total_ms << " ms\n";
+            cout.unsetf(ios::floatfield);
+            cout.precision(oldPrecision);
+            
+            string answer = "Retrieved " + to_string(retrieved.size()) + " relevant chunk(s)";
+            sessionManager.addChatMessage(question, answer, sourceChunks);
+        }
+        else if (command == "reindex") {
+            sessionManager.embedUnindexedChunks();
         }
         else if (command == "list") {
             vector<string> sessions = sessionManager.listSessions();
@@ -216,6 +255,7 @@ public:
                 } else if (tokens[1] == "reload") {
                     auto& config = ConfigManager::getInstance();
                     if (config.loadConfig("config.yaml")) {
+                        sessionManager.reloadConfig();
                         cout << "✅ Configuration reloaded\n";
                     } else {
                         cout << "❌ Failed to reload configuration\n";
@@ -5,6 +5,7 @@
 #include <iomanip>
 #include <sstream>
 #include <algorithm>
+#include <unordered_set>
 #include <sys/stat.h>
 #include <dirent.h>
 #include <unistd.h>
@@ -14,17 +15,24 @@
 #include <cstdio>
 #include <cstdlib>
 #include <nlohmann/json.hpp> // For JSON parsing (add to your includes)
-#include "httplib.h"
 
 using namespace std;
 
-// Requires: cpp-httplib (https://github.com/yhirose/cpp-httplib)
 // Helper functions to replace filesystem operations
 bool path_exists(const string& path) {
     struct stat buffer;
     return (stat(path.c_str(), &buffer) == 0);
 }
 
+// Size and modification time, enough to tell whether a file changed
+// between two add-doc runs without reading it
+string file_version(const string& path) {
+    struct stat buffer;
+    if (stat(path.c_str(), &buffer) != 0) return "";
+    return to_string(buffer.st_size) + ":" + to_string(buffer.st_mtim.tv_sec) + "." +
+           to_string(buffer.st_mtim.tv_nsec);
+}
+
 bool create_directories(const string& path) {
     // Check if path already exists
     if (path_exists(path)) {
@@ -102,6 +110,9 @@ SessionManager::SessionManager(const string &basePath)
         this->baseSessionPath = basePath;
     }
     
+    resetIndex();
+    resetEmbeddingClient();
+    
     // 🔧 FIX: DON'T create directories in constructor
     // Only set the path, don't create anything yet
     
@@ -160,6 +171,7 @@ bool SessionManager::createSession(const string &name, const string &description
     currentMetadata.last_modified = currentMetadata.created_at;
     currentMetadata.total_chunks = 0;
     currentMetadata.total_messages = 0;
+    resetIndex();
 
     // Create session directory
     string sessionPath = baseSessionPath + "/" + sessionId;
@@ -205,6 +217,7 @@ bool SessionManager::deleteSession(const string &name)
         currentSessionName.clear();
         currentDocChunks.clear();
         currentChatHistory.clear();
+        resetIndex();
     }
 
     cout << "✅ Session '" << name << "' deleted successfully.\n";
@@ -275,57 +288,85 @@ bool SessionManager::addDocument(const string &filePath)
         return false;
     }
 
+    // Process document using the document processor; a streamed file
+    // arrives a window of chunks at a time, each embedded and indexed
+    // before the next window is read. Chunk ids are stable per file and
+    // position, so chunks already in the session (from an add-doc that
+    // stopped partway) are skipped and the stream resumes after them, as
+    // long as the file is the one they were cut from
+    string sourceVersion = file_version(filePath);
+    unordered_set<string> indexedIds;
+    size_t resumedChunks = 0;
+    bool changed = false;
+    for (const auto& chunk : currentDocChunks) {
+        if (chunk.source_file == filePath) {
+            indexedIds.insert(chunk.id);
+            changed = changed || chunk.source_version != sourceVersion;
+        }
+    }
     // Check if document is already added
     auto it = find(currentMetadata.documents.begin(), currentMetadata.documents.end(), filePath);
-    if (it != currentMetadata.documents.end())
+    if (it != currentMetadata.documents.end() && !changed)
     {
         cout << "⚠️  Document '" << filePath << "' already added to session.\n";
         return false;
     }
-
-    // Process document using the document processor
+    if (changed) {
+        size_t dropped = removeDocumentChunks(filePath);
+        indexedIds.clear();
+        cout << "♻️  '" << filePath << "' changed since it was added; replacing its " << dropped
+             << " chunks.\n";
+    }
     DocumentProcessor processor;
-    vector<TextChunk> textChunks = processor.processDocument(filePath);
-    if (textChunks.empty()) {
-        cout << "❌ Failed to process document or document is empty.\n";
+    size_t chunksBefore = currentDocChunks.size();
+    size_t cachedChunks = 0;
+    bool embeddingFailed = false;
+    bool processed = processor.streamDocument(filePath, [&](vector<TextChunk>& textChunks) {
+        if (!indexedIds.empty()) {
+            size_t windowChunks = textChunks.size();
+            textChunks.erase(remove_if(textChunks.begin(), textChunks.end(),
+                                       [&](const TextChunk& chunk) { return indexedIds.count(chunk.id) > 0; }),
+                             textChunks.end());
+            resumedChunks += windowChunks - textChunks.size();
+            if (textChunks.empty()) {
+                return true;
+            }
+        }
+        embeddingFailed = !addChunksToIndex(textChunks, sourceVersion, cachedChunks);
+        return !embeddingFailed;
+    });
+    size_t addedChunks = currentDocChunks.size() - chunksBefore;
+    if (!processed) {
+        if (addedChunks > 0 || resumedChunks > 0) {
+            // The index cannot drop rows, so what was indexed stays; the
+            // document is only recorded once every chunk is in
+            currentMetadata.total_chunks = currentDocChunks.size();
+            autoSaveIfEnabled("document_add");
+            cout << "⚠️  Stopped after " << addedChunks + resumedChunks << " chunks of '" << filePath
+                 << "'; add it again to continue from there.\n";
+        } else if (!embeddingFailed) {
+            cout << "❌ Failed to process document or document is empty.\n";
+        }
         return false;
     }
-    // Batch all chunks for embedding
-    std::vector<std::string> chunk_texts, chunk_ids;
-    for (const auto& textChunk : textChunks) {
-        chunk_texts.push_back(textChunk.content);
-        chunk_ids.push_back(textChunk.id);
+    if (addedChunks + resumedChunks == 0) {
+        cout << "❌ Failed to process document or document is empty.\n";
+        return false;
     }
-    nlohmann::json req;
-    req["texts"] = chunk_texts;
-    req["ids"] = chunk_ids;
-    // Send POST request to embedding server
-    httplib::Client cli("127.0.0.1", 8000);
-    auto res = cli.Post("/embed", req.dump(), "application/json");
-    if (!res || res->status != 200) {
-        std::cerr << "Failed to get embeddings from server. Status: " << (res ? res->status : 0) << std::endl;
+    if (addedChunks == 0) {
+        // Every chunk was already in (the documents list is not restored
+        // by load, so this is how a loaded session sees a repeat add-doc)
+        currentMetadata.documents.push_back(filePath);
+        cout << "⚠️  Document '" << filePath << "' already added to session (" << resumedChunks
+             << " chunks).\n";
         return false;
     }
-    // Parse JSON response
-    nlohmann::json resp = nlohmann::json::parse(res->body);
-    std::unordered_map<std::string, std::vector<float>> idToEmbedding;
-    for (const auto& item : resp) {
-        idToEmbedding[item["id"]] = item["embedding"].get<std::vector<float>>();
+    if (resumedChunks > 0) {
+        cout << "⏩ Resumed after " << resumedChunks << " chunks already in the session.\n";
     }
-    // Convert TextChunk to DocumentChunk and add to session
-    for (const auto& textChunk : textChunks) {
-        DocumentChunk chunk;
-        chunk.id = textChunk.id;
-        chunk.content = textChunk.content;
-        chunk.source_file = textChunk.source_file;
-        chunk.chunk_index = textChunk.chunk_index;
-        chunk.start_position = textChunk.start_position;
-        chunk.end_position = textChunk.end_position;
-        // Attach embedding
-        if (idToEmbedding.count(chunk.id)) {
-            chunk.embedding = idToEmbedding[chunk.id];
-        }
-        currentDocChunks.push_back(chunk);
+    if (cachedChunks > 0) {
+        cout << "♻️  Reused cached embeddings for " << cachedChunks << " of " << addedChunks
+             << " chunks.\n";
     }
 
     // Add to metadata
@@ -338,10 +379,10 @@ bool SessionManager::addDocument(const string &filePath)
 
     // 🎯 HYBRID AUTO-SAVE: Save immediately for better UX
     if (autoSaveIfEnabled("document_add")) {
-        cout << "✅ Document '" << filePath << "' processed into " << textChunks.size() 
+        cout << "✅ Document '" << filePath << "' processed into " << addedChunks + resumedChunks 
              << " chunks and saved immediately.\n";
     } else {
-        cout << "✅ Document '" << filePath << "' processed into " << textChunks.size() 
+        cout << "✅ Document '" << filePath << "' processed into " << addedChunks + resumedChunks 
              << " chunks (will save on session close).\n";
     }
     
@@ -349,6 +390,140 @@ bool SessionManager::addDocument(const string &filePath)
 }
 
 
+bool SessionManager::addChunksToIndex(const vector<TextChunk>& textChunks, const string& sourceVersion,
+                                      size_t& cachedChunks) {
+    // Batch all chunks for embedding; the texts are views into the document
+    std::vector<std::string_view> chunk_texts;
+    std::vector<std::string> chunk_ids;
+    for (const auto& textChunk : textChunks) {
+        chunk_texts.push_back(textChunk.content.view());
+        chunk_ids.push_back(textChunk.id);
+    }
+    vector<float> embeddings;  // One row per chunk, in chunk order
+    size_t dim = 0;
+    size_t cached = 0;
+    if (!embeddingClient->embedDocuments(chunk_texts, chunk_ids, embeddings, dim, &cached)) {
+        return false;
+    }
+    cachedChunks += cached;
+    // Convert TextChunk to DocumentChunk and add to session
+    for (size_t i = 0; i < textChunks.size(); ++i) {
+        const TextChunk& textChunk = textChunks[i];
+        DocumentChunk chunk;
+        chunk.id = textChunk.id;
+        chunk.content = textChunk.content.str();  // Session copy: doc_chunks.json keeps every chunk's text
+        chunk.source_file = textChunk.source_file;
+        chunk.chunk_index = textChunk.chunk_index;
+        chunk.start_position = textChunk.start_position;
+        chunk.end_position = textChunk.end_position;
+        chunk.source_version = sourceVersion;
+        // Attach embedding: the row goes from the decoded batch straight
+        // into the index, and the chunk points at it
+        size_t row = currentIndex->size();
+        if (currentIndex->add(chunk.id, &embeddings[i * dim], dim)) {
+            chunk.embedding_row = static_cast<int>(row);
+        }
+        currentDocChunks.push_back(chunk);
+    }
+    return true;
+}
+
+
+size_t SessionManager::removeDocumentChunks(const string& filePath) {
+    // Indexes only append, so the other chunks' vectors are copied into a
+    // fresh one and their rows renumbered
+    shared_ptr<VectorIndex> oldIndex = move(currentIndex);
+    resetIndex();
+    vector<float> embedding(oldIndex->dimension());
+    vector<DocumentChunk> kept;
+    kept.reserve(currentDocChunks.size());
+    for (auto& chunk : currentDocChunks) {
+        if (chunk.source_file == filePath) {
+            continue;
+        }
+        int row = -1;
+        if (chunk.embedding_row >= 0 &&
+            oldIndex->reconstruct(static_cast<size_t>(chunk.embedding_row), embedding.data())) {
+            size_t next = currentIndex->size();
+            if (currentIndex->add(chunk.id, embedding)) {
+                row = static_cast<int>(next);
+            }
+        }
+        chunk.embedding_row = row;
+        kept.push_back(move(chunk));
+    }
+    size_t dropped = currentDocChunks.size() - kept.size();
+    currentDocChunks = move(kept);
+    currentMetadata.documents.erase(
+        remove(currentMetadata.documents.begin(), currentMetadata.documents.end(), filePath),
+        currentMetadata.documents.end());
+    currentMetadata.total_chunks = currentDocChunks.size();
+    return dropped;
+}
+
+size_t SessionManager::countUnindexedChunks() const {
+    size_t unindexed = 0;
+    for (const auto& chunk : currentDocChunks) {
+        if (chunk.embedding_row < 0 && !chunk.content.empty()) {
+            ++unindexed;
+        }
+    }
+    return unindexed;
+}
+
+bool SessionManager::embedUnindexedChunks() {
+    if (!hasActiveSession()) {
+        cout << "❌ No active session.\n";
+        return false;
+    }
+
+    vector<string_view> chunkTexts;
+    vector<string> chunkIds;
+    vector<size_t> positions;
+    for (size_t i = 0; i < currentDocChunks.size(); ++i) {
+        if (currentDocChunks[i].embedding_row < 0 && !currentDocChunks[i].content.empty()) {
+            chunkTexts.push_back(currentDocChunks[i].content);
+            chunkIds.push_back(currentDocChunks[i].id);
+            positions.push_back(i);
+        }
+    }
+    if (positions.empty()) {
+        cout << "✅ Every chunk is already in the index.\n";
+        return true;
+    }
+
+    cout << "🔄 Embedding " << positions.size() << " chunks missing from faiss_index.bin\n";
+    vector<float> embeddings;
+    size_t dim = 0;
+    if (!embeddingClient->embedDocuments(chunkTexts, chunkIds, embeddings, dim)) {
+        cout << "❌ Could not embed them; they stay out of search until reindex succeeds.\n";
+        return false;
+    }
+    // add() refuses rows that do not fit the index (say, a new model with
+    // another dimension); those chunks stay unindexed
+    size_t added = 0;
+    for (size_t i = 0; i < positions.size(); ++i) {
+        DocumentChunk& chunk = currentDocChunks[positions[i]];
+        size_t row = currentIndex->size();
+        if (currentIndex->add(chunk.id, &embeddings[i * dim], dim)) {
+            chunk.embedding_row = static_cast<int>(row);
+            ++added;
+        }
+    }
+    if (added == 0) {
+        cout << "❌ The index accepted none of the " << positions.size() << " embeddings.\n";
+        return false;
+    }
+    autoSaveIfEnabled("document_add");
+    if (added < positions.size()) {
+        cout << "⚠️  Reindexed " << added << " chunks; the index refused " << positions.size() - added
+             << ".\n";
+    } else {
+        cout << "✅ Reindexed " << added << " chunks.\n";
+    }
+    return true;
+}
+
 vector<string> SessionManager::getDocuments() const {
     return currentMetadata.documents;
 }
@@ -358,6 +533,71 @@ vector<DocumentChunk> SessionManager::getDocumentChunks() const {
     return currentDocChunks;
 }
 
+vector<SearchResult> SessionManager::searchChunks(const vector<float>& queryEmbedding, size_t k) const {
+    return currentIndex->search(queryEmbedding, k);
+}
+
+bool SessionManager::queryChunks(const string& question, vector<RetrievedChunk>& results, QueryTiming& timing) {
+    results.clear();
+    timing = QueryTiming();
+    if (!hasActiveSession()) {
+        cout << "❌ No active session.\n";
+        return false;
+    }
+    if (currentIndex->size() == 0) {
+        cout << "⚠️  Session has no embedded documents to search.\n";
+        return true;
+    }
+
+    auto elapsedMs = [](chrono::steady_clock::time_point since) {
+        return chrono::duration<double, milli>(chrono::steady_clock::now() - since).count();
+    };
+    auto start = chrono::steady_clock::now();
+
+    vector<float> queryEmbedding;
+    if (!embeddingClient->embedQuery(question, queryEmbedding, &timing.embedding_cached)) {
+        cout << "❌ Failed to embed the question.\n";
+        return false;
+    }
+    timing.embed_ms = elapsedMs(start);
+
+    const ChatConfig& chatConfig = ConfigManager::getInstance().getChatConfig();
+    auto stage = chrono::steady_clock::now();
+    vector<SearchResult> matches = searchChunks(queryEmbedding, max(chatConfig.max_context_chunks, 0));
+    timing.search_ms = elapsedMs(stage);
+
+    // L2 scores are squared distances; for unit vectors 1 - d^2 / 2 is the
+    // cosine, which puts the threshold on the same scale for both metrics
+    stage = chrono::steady_clock::now();
+    bool l2 = currentIndex->getMetric() == MetricType::L2;
+    for (const SearchResult& match : matches) {
+        float similarity = l2 ? 1.0f - match.score / 2.0f : match.score;
+        if (similarity < chatConfig.similarity_threshold) {
+            break;  // Best first, so nothing after this passes either
+        }
+        // Chunks are embedded in order, so the row is usually the chunk's position
+        const DocumentChunk* chunk = nullptr;
+        if (match.row < currentDocChunks.size() && currentDocChunks[match.row].id == match.id) {
+            chunk = &currentDocChunks[match.row];
+        } else {
+            chunk = findChunk(match.id);
+        }
+        results.push_back({match.id, similarity, chunk});
+    }
+    timing.filter_ms = elapsedMs(stage);
+    timing.total_ms = elapsedMs(start);
+    return true;
+}
+
+const DocumentChunk* SessionManager::findChunk(const string& chunkId) const {
+    for (const auto& chunk : currentDocChunks) {
+        if (chunk.id == chunkId) {
+            return &chunk;
+        }
+    }
+    return nullptr;
+}
+
 bool SessionManager::addChatMessage(const string& question, const string& answer,
                                    const vector<string>& sourceChunks) {
     if (!hasActiveSession()) {
@@ -407,6 +647,12 @@ void SessionManager::printSessionInfo() const {
     cout << "Documents: " << currentMetadata.documents.size() << "\n";
     cout << "Chunks: " << currentMetadata.total_chunks << "\n";
     cout << "Messages: " << currentMetadata.total_messages << "\n";
+    cout << "Index: " << currentIndex->describe() << "\n";
+    const QueryEmbeddingCache& queryCache = embeddingClient->getQueryCache();
+    if (queryCache.enabled()) {
+        cout << "Query cache: " << queryCache.size() << " entries, " << queryCache.hits() << " hits, "
+             << queryCache.misses() << " misses\n";
+    }
     if (!currentMetadata.description.empty()) {
         cout << "Description: " << currentMetadata.description << "\n";
     }
@@ -435,8 +681,11 @@ bool SessionManager::saveEssentialData(const string& sessionId) {
     // Save only the essential data that users expect to see immediately
     currentMetadata.last_modified = getCurrentTimestamp();
     
+    // The index goes first: chunks saved without their rows would come back
+    // unsearchable after a crash
     bool success = true;
     success &= saveMetadata(sessionId);
+    success &= saveFaissIndex(sessionId);
     success &= saveDocumentChunks(sessionId);
     
     if (!success) {
@@ -453,8 +702,8 @@ bool SessionManager::saveAllData(const string& sessionId) {
     bool success = true;
     success &= saveMetadata(sessionId);
     success &= saveChatHistory(sessionId);
-    success &= saveDocumentChunks(sessionId);
     success &= saveFaissIndex(sessionId);
+    success &= saveDocumentChunks(sessionId);
     
     return success;
 }
@@ -542,19 +791,7 @@ bool SessionManager::saveDocumentChunks(const string& sessionId) {
 
 bool SessionManager::saveFaissIndex(const string& sessionId) {
     string filePath = baseSessionPath + "/" + sessionId + "/faiss_index.bin";
-    
-    // TODO: Implement FAISS index saving
-    // For now, create an empty file as placeholder
-    ofstream file(filePath, ios::binary);
-    if (!file.is_open()) {
-        return false;
-    }
-    
-    // Placeholder: Write a simple header to indicate this is a FAISS index file
-    string header = "FAISS_INDEX_V1";
-    file.write(header.c_str(), header.length());
-    file.close();
-    return true;
+    return currentIndex->save(filePath);
 }
 
 bool SessionManager::loadMetadata(const string& sessionId) {
@@ -603,29 +840,37 @@ bool SessionManager::loadDocumentChunks(const string& sessionId) {
                         istreambuf_iterator<char>());
     file.close();
     
-    return parseDocumentChunksFromJson(content);
+    if (!parseDocumentChunksFromJson(content)) {
+        return false;
+    }
+    size_t unindexed = countUnindexedChunks();
+    if (unindexed > 0) {
+        // Embedding them here would make a plain load depend on the server
+        cout << "⚠️  " << unindexed << " chunks are missing from faiss_index.bin and left out of search; "
+             << "run 'reindex' to embed them.\n";
+    }
+    return true;
 }
 
 bool SessionManager::loadFaissIndex(const string& sessionId) {
     string filePath = baseSessionPath + "/" + sessionId + "/faiss_index.bin";
+    resetIndex();
     
     if (!path_exists(filePath)) {
         // Index file might not exist for sessions without documents
         return true;
     }
     
-    // TODO: Implement FAISS index loading
-    // For now, just verify the file exists and has the header
-    ifstream file(filePath, ios::binary);
-    if (!file.is_open()) {
-        return false;
+    auto& configManager = ConfigManager::getInstance();
+    auto loaded = loadIndexFile(filePath, configManager.getVectorDbConfig(), configManager.getSessionConfig());
+    if (!loaded) {
+        // Old placeholder or damaged file: only sessions that still carry
+        // embeddings in doc_chunks.json get rows back from there on parse
+        cout << "⚠️  Could not read " << filePath << "\n";
+        return true;
     }
-    
-    string header(14, '\0');  // "FAISS_INDEX_V1" length
-    file.read(&header[0], 14);
-    file.close();
-    
-    return header == "FAISS_INDEX_V1";
+    currentIndex = loaded;
+    return true;
 }
 
 bool SessionManager::loadSession(const string& name) {
@@ -651,8 +896,8 @@ bool SessionManager::loadSession(const string& name) {
     bool success = true;
     success &= loadMetadata(sessionId);
     success &= loadChatHistory(sessionId);
+    success &= loadFaissIndex(sessionId);     // Before chunks: lets chunk parsing skip embeddings
     success &= loadDocumentChunks(sessionId);
-    success &= loadFaissIndex(sessionId);  // Updated method name
 
     if (success) {
         currentSessionName = name;
@@ -729,7 +974,11 @@ string SessionManager::documentChunksToJson() {
         chunk_j["chunk_index"] = chunk.chunk_index;
         chunk_j["start_position"] = chunk.start_position;
         chunk_j["end_position"] = chunk.end_position;
-        chunk_j["embedding"] = chunk.embedding;
+        chunk_j["source_version"] = chunk.source_version;
+        // The vectors themselves live in faiss_index.bin
+        if (chunk.embedding_row >= 0) {
+            chunk_j["embedding_row"] = chunk.embedding_row;
+        }
         j["chunks"].push_back(chunk_j);
     }
     return j.dump(2); // pretty print
@@ -752,9 +1001,72 @@ bool SessionManager::parseChatHistoryFromJson(const string& json) {
 }
 
 bool SessionManager::parseDocumentChunksFromJson(const string& json) {
-    (void)json;
-    // TODO: Implement proper JSON parsing
     currentDocChunks.clear();
+    
+    // Sessions saved before faiss_index.bin existed carry an embedding array
+    // per chunk. With a loaded index those are redundant, so drop them during
+    // parsing instead of materializing thousands of floats per chunk.
+    bool haveIndex = currentIndex->size() > 0;
+    auto skipEmbeddings = [haveIndex](int, nlohmann::json::parse_event_t event, nlohmann::json& parsed) {
+        return !(haveIndex && event == nlohmann::json::parse_event_t::key && parsed == "embedding");
+    };
+    nlohmann::json j = nlohmann::json::parse(json, skipEmbeddings, false);
+    if (j.is_discarded() || !j.contains("chunks")) {
+        cout << "❌ Failed to parse doc_chunks.json\n";
+        return false;
+    }
+    
+    vector<float> embedding;  // Reused for every chunk
+    size_t legacyRows = 0;
+    for (const auto& chunk_j : j["chunks"]) {
+        DocumentChunk chunk;
+        chunk.id = chunk_j.value("id", "");
+        chunk.content = chunk_j.value("content", "");
+        chunk.source_file = chunk_j.value("source_file", "");
+        chunk.chunk_index = chunk_j.value("chunk_index", 0);
+        chunk.start_position = chunk_j.value("start_position", (size_t)0);
+        chunk.end_position = chunk_j.value("end_position", (size_t)0);
+        chunk.source_version = chunk_j.value("source_version", "");
+        // Without a loaded index, saved rows point at nothing
+        chunk.embedding_row = haveIndex ? chunk_j.value("embedding_row", -1) : -1;
+
+        // With a loaded index, rows are resolved against it below
+        if (!haveIndex && chunk_j.contains("embedding")) {
+            chunk.embedding_row = -1;
+            const nlohmann::json& values = chunk_j["embedding"];
+            embedding.resize(values.size());
+            for (size_t d = 0; d < values.size(); ++d) embedding[d] = values[d].get<float>();
+            size_t row = currentIndex->size();
+            if (currentIndex->add(chunk.id, embedding)) {
+                chunk.embedding_row = static_cast<int>(row);
+                ++legacyRows;
+            }
+        }
+        currentDocChunks.push_back(chunk);
+    }
+    if (legacyRows > 0) {
+        cout << "♻️  Rebuilt the index from " << legacyRows << " embeddings stored in doc_chunks.json\n";
+    }
+    
+    if (haveIndex) {
+        // Index rows are appended in chunk order; fall back to an id lookup
+        // if the two files ever disagree
+        unordered_map<string, size_t> rowById;
+        for (size_t row = 0; row < currentIndex->size(); ++row) {
+            rowById[currentIndex->idAt(row)] = row;
+        }
+        for (size_t i = 0; i < currentDocChunks.size(); ++i) {
+            DocumentChunk& chunk = currentDocChunks[i];
+            size_t row = chunk.embedding_row >= 0 ? static_cast<size_t>(chunk.embedding_row) : i;
+            if (row >= currentIndex->size() || currentIndex->idAt(row) != chunk.id) {
+                auto it = rowById.find(chunk.id);
+                row = it == rowById.end() ? currentIndex->size() : it->second;
+            }
+            chunk.embedding_row = row < currentIndex->size() ? static_cast<int>(row) : -1;
+        }
+    }
+    
+    currentMetadata.total_chunks = currentDocChunks.size();
     return true;
 }
 
@@ -829,6 +1141,7 @@ void SessionManager::closeSession() {
         currentDocChunks.clear();
         currentChatHistory.clear();
         currentMetadata = SessionMetadata();
+        resetIndex();
     }
 }
 
@@ -841,4 +1154,21 @@ bool SessionManager::ensureBaseDirectoryExists() {
         }
     }
     return true;
+}
+
+void SessionManager::resetEmbeddingClient() {
+    auto& configManager = ConfigManager::getInstance();
+    embeddingClient = make_shared<EmbeddingClient>(configManager.getEmbeddingConfig(),
+                                                   configManager.getPerformanceConfig(),
+                                                   configManager.getPathsConfig());
+}
+
+void SessionManager::reloadConfig() {
+    // The old client's connections and query cache go with it
+    resetEmbeddingClient();
+}
+
+void SessionManager::resetIndex() {
+    auto& configManager = ConfigManager::getInstance();
+    currentIndex = createIndex(configManager.getVectorDbConfig(), configManager.getEmbeddingConfig());
 }
\ No newline at end of file
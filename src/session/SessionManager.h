@@ -5,9 +5,13 @@
 #include <vector>
 #include <map>
 #include <memory>
+#include "../vector_db/VectorIndex.h"
+#include "../embedding/EmbeddingClient.h"
 
 using namespace std;
 
+struct TextChunk;
+
 struct DocumentChunk {
     string id;
     string content;
@@ -15,7 +19,8 @@ struct DocumentChunk {
     int chunk_index;
     size_t start_position;
     size_t end_position;
-    vector<float> embedding; // Embedding vector for semantic search
+    int embedding_row = -1;  // Row in the session's vector index, -1 if none
+    string source_version;   // Size and mtime of source_file when it was chunked
 };
 
 struct ChatMessage {
@@ -26,6 +31,22 @@ struct ChatMessage {
     vector<string> source_chunks; // References to relevant document chunks
 };
 
+// A chunk returned by queryChunks(), best first
+struct RetrievedChunk {
+    string chunk_id;
+    float similarity;               // Cosine-style: higher is closer
+    const DocumentChunk* chunk;     // Into the session's chunks; nullptr if unknown
+};
+
+// Wall-clock time of each query stage, in milliseconds
+struct QueryTiming {
+    double embed_ms = 0.0;
+    double search_ms = 0.0;
+    double filter_ms = 0.0;
+    double total_ms = 0.0;
+    bool embedding_cached = false;  // Question embedding came from the query cache
+};
+
 struct SessionMetadata {
     string name;
     string created_at;
@@ -46,6 +67,9 @@ private:
     SessionMetadata currentMetadata;
     vector<DocumentChunk> currentDocChunks;
     vector<ChatMessage> currentChatHistory;
+    shared_ptr<VectorIndex> currentIndex;  // Embeddings of currentDocChunks, persisted as faiss_index.bin;
+                                           // the only copy of the vectors in memory
+    shared_ptr<EmbeddingClient> embeddingClient;
     
     // Auto-save configuration
     bool autoSaveEnabled = true;
@@ -57,6 +81,17 @@ private:
     string getCurrentTimestamp();
     string generateUniqueId();
     bool ensureBaseDirectoryExists();  // 🆕 ADD THIS
+    void resetIndex();                 // Empty index of the configured vector_db type, no embeddings
+    void resetEmbeddingClient();       // New client from the current embedding/performance config
+    // Embeds the chunks and appends them to the index and currentDocChunks;
+    // adds how many embeddings came from the document cache to cachedChunks
+    bool addChunksToIndex(const vector<TextChunk>& textChunks, const string& sourceVersion,
+                          size_t& cachedChunks);
+    // Drops a file's chunks and rebuilds the index without their rows;
+    // returns how many chunks were dropped
+    size_t removeDocumentChunks(const string& filePath);
+    // Loaded chunks that have no row in the index (one saved before a crash)
+    size_t countUnindexedChunks() const;
     
     // File operations
     bool createSessionDirectory(const string& sessionId);
@@ -81,7 +116,7 @@ private:
     
     // Helper methods for selective saving
     bool autoSaveIfEnabled(const string& operation = "");
-    bool saveEssentialData(const string& sessionId);  // Only metadata + doc chunks
+    bool saveEssentialData(const string& sessionId);  // Only metadata + index + doc chunks
     bool saveAllData(const string& sessionId);        // Everything
 
 public:
@@ -95,6 +130,11 @@ public:
     bool saveCurrentSession();
     void closeSession(); 
     
+    // Picks up a reloaded config.yaml: the embedding client (batching,
+    // timeouts, retries, circuit breaker, caches) is rebuilt. vector_db
+    // settings apply from the next session created or loaded
+    void reloadConfig();
+    
     // Session info
     vector<string> listSessions();
     bool hasActiveSession() const;
@@ -105,6 +145,17 @@ public:
     bool addDocument(const string& filePath);
     vector<string> getDocuments() const;
     vector<DocumentChunk> getDocumentChunks() const;
+    // Embeds the chunks that have no row in the index and saves; loading a
+    // session only reports them, so the embedding server is never called
+    // behind a plain load
+    bool embedUnindexedChunks();
+    
+    // Search
+    vector<SearchResult> searchChunks(const vector<float>& queryEmbedding, size_t k) const;
+    const DocumentChunk* findChunk(const string& chunkId) const;
+    // Embeds the question, searches the index and keeps at most
+    // chat.max_context_chunks results with similarity >= chat.similarity_threshold
+    bool queryChunks(const string& question, vector<RetrievedChunk>& results, QueryTiming& timing);
     
     // Chat management
     bool addChatMessage(const string& question, const string& answer, 
@@ -0,0 +1,177 @@
+#include "BinaryIndex.h"
+#include "DistanceKernels.h"
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cstdio>
+
+// Codes compared per kernel call; 256 codes of 256 bits is 8 KB
+static const size_t SCAN_BLOCK_ROWS = 256;
+
+BinaryIndex::BinaryIndex(size_t dim, MetricType metric, size_t candidates)
+    : dim(dim), metric(metric), candidates(candidates), words((dim + 63) / 64) {
+    rawVectors.setDimension(dim);
+}
+
+void BinaryIndex::binarize(const float* vec, size_t dim, uint64_t* out) {
+    size_t words = (dim + 63) / 64;
+    fill(out, out + words, 0);
+    for (size_t d = 0; d < dim; ++d) {
+        if (vec[d] > 0.0f) out[d / 64] |= uint64_t(1) << (d % 64);
+    }
+}
+
+bool BinaryIndex::add(const string& id, const float* embedding, size_t embeddingDim) {
+    if (embedding == nullptr || embeddingDim == 0) {
+        return false;
+    }
+    if (ids.empty()) {
+        // The first vector fixes the dimension; the configured dim is only a hint
+        dim = embeddingDim;
+        words = (dim + 63) / 64;
+        rawVectors.setDimension(dim);
+    }
+    if (embeddingDim != dim) {
+        cout << "⚠️  Embedding for '" << id << "' has dimension " << embeddingDim
+             << ", index expects " << dim << ". Skipping.\n";
+        return false;
+    }
+
+    size_t offset = codes.size();
+    codes.resize(offset + words);
+    binarize(embedding, dim, &codes[offset]);
+    rawVectors.append(embedding);
+    ids.push_back(id);
+    return true;
+}
+
+void BinaryIndex::clear() {
+    codes.clear();
+    ids.clear();
+    rawVectors.clear();
+}
+
+bool BinaryIndex::reconstruct(size_t row, float* out) const {
+    return rawVectors.read(row, out);
+}
+
+vector<SearchResult> BinaryIndex::searchVectors(const float* query, size_t k,
+                                                const SearchParams& params) const {
+    (void)params;
+    const DistanceKernels& kernels = distanceKernels();
+    size_t count = ids.size();
+
+    // Hamming pass: smaller distance ranks higher
+    vector<uint64_t> queryCode(words);
+    binarize(query, dim, queryCode.data());
+    TopK shortlist(min(max(k, candidates), count));
+    uint32_t distances[SCAN_BLOCK_ROWS];
+    for (size_t begin = 0; begin < count; begin += SCAN_BLOCK_ROWS) {
+        size_t blockRows = min(SCAN_BLOCK_ROWS, count - begin);
+        kernels.hammingBatch(queryCode.data(), &codes[begin * words], blockRows, words, distances);
+
+        float threshold = shortlist.threshold();
+        for (size_t i = 0; i < blockRows; ++i) {
+            float key = -static_cast<float>(distances[i]);
+            if (key > threshold) {
+                shortlist.push(key, begin + i);
+                threshold = shortlist.threshold();
+            }
+        }
+    }
+
+    // Float re-scoring, in row order so disk reads move forward through the file
+    vector<pair<float, size_t>> rows = shortlist.takeSorted();
+    sort(rows.begin(), rows.end(),
+         [](const pair<float, size_t>& a, const pair<float, size_t>& b) { return a.second < b.second; });
+    bool l2 = metric == MetricType::L2;
+    TopK heap(min(k, rows.size()));
+    vector<float> vec(dim);
+    for (const auto& row : rows) {
+        if (!rawVectors.read(row.second, vec.data())) continue;
+        float score = l2 ? -kernels.l2Squared(query, vec.data(), dim)
+                         : kernels.innerProduct(query, vec.data(), dim);
+        heap.push(score, row.second);
+    }
+    return collectResults(heap, metric, *this);
+}
+
+string BinaryIndex::describe() const {
+    stringstream ss;
+    ss << VectorIndex::describe() << ", " << words * 8 << "-byte codes, "
+       << candidates << " candidates";
+    return ss.str();
+}
+
+// Body layout after the common header (params[0] = words per code):
+//   uint64 codes[count * words], then the full-precision matrix
+//   (count * dim floats), read lazily after load
+bool BinaryIndex::save(const string& filePath) const {
+    string tempPath = filePath + ".tmp";
+    ofstream file(tempPath, ios::binary | ios::trunc);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    IndexFileHeader header = makeIndexHeader(IndexType::Binary, metric, dim, ids.size());
+    header.id_bytes = idTableBytes(ids);
+    header.params[0] = static_cast<uint32_t>(words);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    file.write(reinterpret_cast<const char*>(codes.data()), codes.size() * sizeof(uint64_t));
+    uint64_t rawStart = static_cast<uint64_t>(file.tellp());
+    bool ok = rawVectors.write(file);
+    writeIdTable(file, ids);
+    file.close();
+
+    if (!ok || !file) {
+        remove(tempPath.c_str());
+        return false;
+    }
+    if (!commitIndexFile(tempPath, filePath)) {
+        return false;
+    }
+
+    // The saved file becomes the backing store for full vectors
+    rawVectors.attach(filePath, rawStart, ids.size());
+    return true;
+}
+
+bool BinaryIndex::load(const string& filePath) {
+    ifstream file(filePath, ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    IndexFileHeader header;
+    if (!readIndexHeader(file, header) ||
+        header.index_type != static_cast<uint32_t>(IndexType::Binary) ||
+        header.params[0] != (header.dim + 63) / 64 ||
+        // Packed codes, then the full vectors for re-scoring
+        !indexBodyFits(file, header, uint64_t(header.params[0]) * sizeof(uint64_t) +
+                                         uint64_t(header.dim) * sizeof(float))) {
+        return false;
+    }
+
+    clear();
+    dim = header.dim;
+    metric = static_cast<MetricType>(header.metric);
+    words = header.params[0];
+    size_t count = header.count;
+    rawVectors.setDimension(dim);
+
+    codes.resize(count * words);
+    if (!file.read(reinterpret_cast<char*>(codes.data()), codes.size() * sizeof(uint64_t))) {
+        clear();
+        return false;
+    }
+    uint64_t rawStart = static_cast<uint64_t>(file.tellg());
+    file.seekg(static_cast<streamoff>(count * dim * sizeof(float)), ios::cur);
+
+    if (!readIdTable(file, count, header.id_bytes, ids) ||
+        !rawVectors.attach(filePath, rawStart, count)) {
+        clear();
+        return false;
+    }
+    return true;
+}
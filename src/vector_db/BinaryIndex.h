@@ -0,0 +1,65 @@
+#ifndef BINARY_INDEX_H
+#define BINARY_INDEX_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "VectorIndex.h"
+#include "RawVectorStore.h"
+
+using namespace std;
+
+// Exact scan over 1-bit codes (IndexBinaryFlat). Each dimension keeps only
+// its sign, so a 256-dim vector becomes four 64-bit words (32 bytes instead
+// of 1 KB) and is compared to the query's code by Hamming distance with
+// POPCNT / AVX-512 VPOPCNTDQ.
+//
+// Hamming order alone is coarse, so the best max(k, candidates) codes are
+// re-scored with the float metric. Full-precision vectors live in the index
+// file and are read back with pread() for that re-scoring, as in IvfPqIndex.
+class BinaryIndex : public VectorIndex {
+public:
+    BinaryIndex(size_t dim, MetricType metric, size_t candidates);
+
+    using VectorIndex::add;
+    bool add(const string& id, const float* embedding, size_t embeddingDim) override;
+    void clear() override;
+
+    size_t size() const override { return ids.size(); }
+    size_t dimension() const override { return dim; }
+    MetricType getMetric() const override { return metric; }
+    IndexType getType() const override { return IndexType::Binary; }
+
+    const string& idAt(size_t row) const override { return ids[row]; }
+    // Exact: reads the full vector, from disk for saved rows
+    bool reconstruct(size_t row, float* out) const override;
+
+    size_t getCandidates() const { return candidates; }
+    void setCandidates(size_t value) { candidates = value; }
+
+    // Sign bits of vec, dimension d at bit d % 64 of word d / 64
+    static void binarize(const float* vec, size_t dim, uint64_t* out);
+
+    bool save(const string& filePath) const override;
+    bool load(const string& filePath) override;
+
+    string describe() const override;
+
+protected:
+    vector<SearchResult> searchVectors(const float* query, size_t k,
+                                       const SearchParams& params) const override;
+
+private:
+    size_t dim;
+    MetricType metric;
+    size_t candidates;              // Hamming shortlist re-scored in float
+    size_t words;                   // 64-bit words per code
+
+    vector<uint64_t> codes;         // count x words
+    vector<string> ids;
+
+    // See IvfPqIndex: save() moves the rows to disk, hence mutable
+    mutable RawVectorStore rawVectors;
+};
+
+#endif // BINARY_INDEX_H
@@ -0,0 +1,603 @@
+#include "DistanceKernels.h"
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define MIMIR_X86_KERNELS 1
+#endif
+
+// ---------------------------------------------------------------------------
+// Scalar fallback (four accumulators so the compiler can still vectorize)
+// ---------------------------------------------------------------------------
+
+static float innerProductScalar(const float* a, const float* b, size_t dim) {
+    float s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    size_t i = 0;
+    for (; i + 4 <= dim; i += 4) {
+        s0 += a[i] * b[i];
+        s1 += a[i + 1] * b[i + 1];
+        s2 += a[i + 2] * b[i + 2];
+        s3 += a[i + 3] * b[i + 3];
+    }
+    for (; i < dim; ++i) {
+        s0 += a[i] * b[i];
+    }
+    return (s0 + s1) + (s2 + s3);
+}
+
+static float l2SquaredScalar(const float* a, const float* b, size_t dim) {
+    float s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    size_t i = 0;
+    for (; i + 4 <= dim; i += 4) {
+        float d0 = a[i] - b[i];
+        float d1 = a[i + 1] - b[i + 1];
+        float d2 = a[i + 2] - b[i + 2];
+        float d3 = a[i + 3] - b[i + 3];
+        s0 += d0 * d0;
+        s1 += d1 * d1;
+        s2 += d2 * d2;
+        s3 += d3 * d3;
+    }
+    for (; i < dim; ++i) {
+        float d = a[i] - b[i];
+        s0 += d * d;
+    }
+    return (s0 + s1) + (s2 + s3);
+}
+
+static void innerProductBatchScalar(const float* query, const float* rows, size_t count, size_t dim, float* out) {
+    for (size_t r = 0; r < count; ++r) {
+        out[r] = innerProductScalar(query, rows + r * dim, dim);
+    }
+}
+
+static void l2SquaredBatchScalar(const float* query, const float* rows, size_t count, size_t dim, float* out) {
+    for (size_t r = 0; r < count; ++r) {
+        out[r] = l2SquaredScalar(query, rows + r * dim, dim);
+    }
+}
+
+static void pqLookupBlocksScalar(const float* lut, const uint8_t* codes, size_t blocks, size_t m, float* out) {
+    for (size_t b = 0; b < blocks; ++b) {
+        float* sums = out + b * PQ_BLOCK;
+        for (size_t j = 0; j < PQ_BLOCK; ++j) sums[j] = 0.0f;
+        for (size_t sub = 0; sub < m; ++sub) {
+            const uint8_t* code = codes + sub * PQ_BLOCK;
+            const float* table = lut + sub * PQ_KSUB;
+            for (size_t j = 0; j < PQ_BLOCK; ++j) sums[j] += table[code[j]];
+        }
+        codes += m * PQ_BLOCK;
+    }
+}
+
+static void int8DotBatchScalar(const int8_t* query, const int8_t* rows, size_t count, size_t dim, int32_t* out) {
+    for (size_t r = 0; r < count; ++r) {
+        const int8_t* row = rows + r * dim;
+        int32_t sum = 0;
+        for (size_t i = 0; i < dim; ++i) sum += int32_t(query[i]) * int32_t(row[i]);
+        out[r] = sum;
+    }
+}
+
+static void fp16InnerProductBatchScalar(const float* query, const uint16_t* rows, size_t count, size_t dim, float* out) {
+    for (size_t r = 0; r < count; ++r) {
+        const uint16_t* row = rows + r * dim;
+        float sum = 0;
+        for (size_t i = 0; i < dim; ++i) sum += query[i] * halfToFloat(row[i]);
+        out[r] = sum;
+    }
+}
+
+static void fp16L2SquaredBatchScalar(const float* query, const uint16_t* rows, size_t count, size_t dim, float* out) {
+    for (size_t r = 0; r < count; ++r) {
+        const uint16_t* row = rows + r * dim;
+        float sum = 0;
+        for (size_t i = 0; i < dim; ++i) {
+            float d = query[i] - halfToFloat(row[i]);
+            sum += d * d;
+        }
+        out[r] = sum;
+    }
+}
+
+static void hammingBatchScalar(const uint64_t* query, const uint64_t* codes, size_t count, size_t words, uint32_t* out) {
+    for (size_t r = 0; r < count; ++r) {
+        const uint64_t* code = codes + r * words;
+        uint32_t distance = 0;
+        for (size_t w = 0; w < words; ++w) distance += __builtin_popcountll(query[w] ^ code[w]);
+        out[r] = distance;
+    }
+}
+
+uint16_t floatToHalf(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    uint32_t sign = (bits >> 16) & 0x8000;
+    uint32_t absBits = bits & 0x7fffffff;
+
+    if (absBits >= 0x7f800000) {
+        // Inf stays inf, NaN stays a (quiet) NaN
+        return static_cast<uint16_t>(sign | 0x7c00 | (absBits > 0x7f800000 ? 0x200 : 0));
+    }
+    if (absBits >= 0x477ff000) {
+        // Rounds past the largest half (65504)
+        return static_cast<uint16_t>(sign | 0x7c00);
+    }
+    if (absBits < 0x38800000) {
+        // Half subnormal range: shift the full mantissa into 2^-24 units
+        if (absBits < 0x33000000) {
+            return static_cast<uint16_t>(sign);
+        }
+        uint32_t exponent = absBits >> 23;
+        uint32_t mantissa = (absBits & 0x7fffff) | 0x800000;
+        uint32_t shift = 126 - exponent;
+        uint32_t half = mantissa >> shift;
+        uint32_t rest = mantissa & ((1u << shift) - 1);
+        uint32_t halfway = 1u << (shift - 1);
+        if (rest > halfway || (rest == halfway && (half & 1))) half++;
+        return static_cast<uint16_t>(sign | half);
+    }
+
+    // Normal: rebias the exponent and round 23 mantissa bits to 10; a carry
+    // out of the mantissa correctly bumps the exponent
+    uint32_t half = (absBits - 0x38000000) >> 13;
+    uint32_t rest = absBits & 0x1fff;
+    if (rest > 0x1000 || (rest == 0x1000 && (half & 1))) half++;
+    return static_cast<uint16_t>(sign | half);
+}
+
+float halfToFloat(uint16_t value) {
+    uint32_t sign = uint32_t(value & 0x8000) << 16;
+    uint32_t exponent = (value >> 10) & 0x1f;
+    uint32_t mantissa = value & 0x3ff;
+    uint32_t bits;
+
+    if (exponent == 0) {
+        if (mantissa == 0) {
+            bits = sign;
+        } else {
+            // Subnormal: normalize into a float exponent
+            exponent = 113;
+            while (!(mantissa & 0x400)) {
+                mantissa <<= 1;
+                exponent--;
+            }
+            bits = sign | (exponent << 23) | ((mantissa & 0x3ff) << 13);
+        }
+    } else if (exponent == 31) {
+        bits = sign | 0x7f800000 | (mantissa << 13);
+    } else {
+        bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+    }
+
+    float result;
+    memcpy(&result, &bits, sizeof(result));
+    return result;
+}
+
+#ifdef MIMIR_X86_KERNELS
+
+// ---------------------------------------------------------------------------
+// POPCNT (same loop as the scalar version, but the builtin becomes one
+// instruction instead of a bit-twiddling sequence)
+// ---------------------------------------------------------------------------
+
+__attribute__((target("popcnt")))
+static void hammingBatchPopcnt(const uint64_t* query, const uint64_t* codes, size_t count, size_t words, uint32_t* out) {
+    for (size_t r = 0; r < count; ++r) {
+        const uint64_t* code = codes + r * words;
+        uint32_t distance = 0;
+        for (size_t w = 0; w < words; ++w) distance += __builtin_popcountll(query[w] ^ code[w]);
+        out[r] = distance;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// AVX2 + FMA
+// ---------------------------------------------------------------------------
+
+__attribute__((target("avx2,fma")))
+static inline float horizontalSumAvx2(__m256 v) {
+    __m128 lo = _mm256_castps256_ps128(v);
+    __m128 hi = _mm256_extractf128_ps(v, 1);
+    lo = _mm_add_ps(lo, hi);
+    __m128 shuf = _mm_movehdup_ps(lo);
+    __m128 sums = _mm_add_ps(lo, shuf);
+    shuf = _mm_movehl_ps(shuf, sums);
+    sums = _mm_add_ss(sums, shuf);
+    return _mm_cvtss_f32(sums);
+}
+
+__attribute__((target("avx2,fma")))
+static inline float innerProductAvx2(const float* a, const float* b, size_t dim) {
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    __m256 acc2 = _mm256_setzero_ps();
+    __m256 acc3 = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 32 <= dim; i += 32) {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+        acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8), acc1);
+        acc2 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 16), _mm256_loadu_ps(b + i + 16), acc2);
+        acc3 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 24), _mm256_loadu_ps(b + i + 24), acc3);
+    }
+    for (; i + 8 <= dim; i += 8) {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+    }
+    float sum = horizontalSumAvx2(_mm256_add_ps(_mm256_add_ps(acc0, acc1), _mm256_add_ps(acc2, acc3)));
+    for (; i < dim; ++i) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+__attribute__((target("avx2,fma")))
+static inline float l2SquaredAvx2(const float* a, const float* b, size_t dim) {
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= dim; i += 16) {
+        __m256 d0 = _mm256_sub_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i));
+        __m256 d1 = _mm256_sub_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8));
+        acc0 = _mm256_fmadd_ps(d0, d0, acc0);
+        acc1 = _mm256_fmadd_ps(d1, d1, acc1);
+    }
+    for (; i + 8 <= dim; i += 8) {
+        __m256 d0 = _mm256_sub_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i));
+        acc0 = _mm256_fmadd_ps(d0, d0, acc0);
+    }
+    float sum = horizontalSumAvx2(_mm256_add_ps(acc0, acc1));
+    for (; i < dim; ++i) {
+        float d = a[i] - b[i];
+        sum += d * d;
+    }
+    return sum;
+}
+
+__attribute__((target("avx2,fma")))
+static float innerProductAvx2Entry(const float* a, const float* b, size_t dim) {
+    return innerProductAvx2(a, b, dim);
+}
+
+__attribute__((target("avx2,fma")))
+static float l2SquaredAvx2Entry(const float* a, const float* b, size_t dim) {
+    return l2SquaredAvx2(a, b, dim);
+}
+
+__attribute__((target("avx2,fma")))
+static void innerProductBatchAvx2(const float* query, const float* rows, size_t count, size_t dim, float* out) {
+    for (size_t r = 0; r < count; ++r) {
+        out[r] = innerProductAvx2(query, rows + r * dim, dim);
+    }
+}
+
+__attribute__((target("avx2,fma")))
+static void l2SquaredBatchAvx2(const float* query, const float* rows, size_t count, size_t dim, float* out) {
+    for (size_t r = 0; r < count; ++r) {
+        out[r] = l2SquaredAvx2(query, rows + r * dim, dim);
+    }
+}
+
+// Two 8-wide gathers per sub-quantizer cover one 16-vector block
+__attribute__((target("avx2,fma")))
+static void pqLookupBlocksAvx2(const float* lut, const uint8_t* codes, size_t blocks, size_t m, float* out) {
+    for (size_t b = 0; b < blocks; ++b) {
+        __m256 acc0 = _mm256_setzero_ps();
+        __m256 acc1 = _mm256_setzero_ps();
+        for (size_t sub = 0; sub < m; ++sub) {
+            __m128i code = _mm_loadu_si128(reinterpret_cast<const __m128i*>(codes + sub * PQ_BLOCK));
+            const float* table = lut + sub * PQ_KSUB;
+            acc0 = _mm256_add_ps(acc0, _mm256_i32gather_ps(table, _mm256_cvtepu8_epi32(code), 4));
+            acc1 = _mm256_add_ps(acc1, _mm256_i32gather_ps(table, _mm256_cvtepu8_epi32(_mm_srli_si128(code, 8)), 4));
+        }
+        _mm256_storeu_ps(out + b * PQ_BLOCK, acc0);
+        _mm256_storeu_ps(out + b * PQ_BLOCK + 8, acc1);
+        codes += m * PQ_BLOCK;
+    }
+}
+
+// maddubs multiplies unsigned by signed bytes, so move a's sign onto b:
+// |a| * (sign(a) * b) == a * b. Pair sums stay within int16 for |x| <= 127.
+__attribute__((target("avx2")))
+static void int8DotBatchAvx2(const int8_t* query, const int8_t* rows, size_t count, size_t dim, int32_t* out) {
+    const __m256i ones = _mm256_set1_epi16(1);
+    for (size_t r = 0; r < count; ++r) {
+        const int8_t* row = rows + r * dim;
+        __m256i acc = _mm256_setzero_si256();
+        size_t i = 0;
+        for (; i + 32 <= dim; i += 32) {
+            __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(query + i));
+            __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + i));
+            __m256i pairs = _mm256_maddubs_epi16(_mm256_sign_epi8(a, a), _mm256_sign_epi8(b, a));
+            acc = _mm256_add_epi32(acc, _mm256_madd_epi16(pairs, ones));
+        }
+        __m128i sum = _mm_add_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+        sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+        sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+        int32_t total = _mm_cvtsi128_si32(sum);
+        for (; i < dim; ++i) total += int32_t(query[i]) * int32_t(row[i]);
+        out[r] = total;
+    }
+}
+
+__attribute__((target("avx2,fma,f16c")))
+static void fp16InnerProductBatchF16c(const float* query, const uint16_t* rows, size_t count, size_t dim, float* out) {
+    for (size_t r = 0; r < count; ++r) {
+        const uint16_t* row = rows + r * dim;
+        __m256 acc0 = _mm256_setzero_ps();
+        __m256 acc1 = _mm256_setzero_ps();
+        size_t i = 0;
+        for (; i + 16 <= dim; i += 16) {
+            __m256 v0 = _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i)));
+            __m256 v1 = _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i + 8)));
+            acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(query + i), v0, acc0);
+            acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(query + i + 8), v1, acc1);
+        }
+        float sum = horizontalSumAvx2(_mm256_add_ps(acc0, acc1));
+        for (; i < dim; ++i) sum += query[i] * halfToFloat(row[i]);
+        out[r] = sum;
+    }
+}
+
+__attribute__((target("avx2,fma,f16c")))
+static void fp16L2SquaredBatchF16c(const float* query, const uint16_t* rows, size_t count, size_t dim, float* out) {
+    for (size_t r = 0; r < count; ++r) {
+        const uint16_t* row = rows + r * dim;
+        __m256 acc0 = _mm256_setzero_ps();
+        __m256 acc1 = _mm256_setzero_ps();
+        size_t i = 0;
+        for (; i + 16 <= dim; i += 16) {
+            __m256 d0 = _mm256_sub_ps(_mm256_loadu_ps(query + i),
+                                      _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i))));
+            __m256 d1 = _mm256_sub_ps(_mm256_loadu_ps(query + i + 8),
+                                      _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i + 8))));
+            acc0 = _mm256_fmadd_ps(d0, d0, acc0);
+            acc1 = _mm256_fmadd_ps(d1, d1, acc1);
+        }
+        float sum = horizontalSumAvx2(_mm256_add_ps(acc0, acc1));
+        for (; i < dim; ++i) {
+            float d = query[i] - halfToFloat(row[i]);
+            sum += d * d;
+        }
+        out[r] = sum;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// AVX-512F (masked loads handle the tail, so no scalar remainder loop)
+// ---------------------------------------------------------------------------
+
+// GCC 12's AVX-512 headers trip -Wmaybe-uninitialized on their own
+// _mm*_undefined_* placeholders once inlined (GCC bug 105593)
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+__attribute__((target("avx512f")))
+static inline float innerProductAvx512(const float* a, const float* b, size_t dim) {
+    __m512 acc0 = _mm512_setzero_ps();
+    __m512 acc1 = _mm512_setzero_ps();
+    size_t i = 0;
+    for (; i + 32 <= dim; i += 32) {
+        acc0 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i), acc0);
+        acc1 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i + 16), _mm512_loadu_ps(b + i + 16), acc1);
+    }
+    for (; i + 16 <= dim; i += 16) {
+        acc0 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i), acc0);
+    }
+    if (i < dim) {
+        __mmask16 mask = (__mmask16)((1u << (dim - i)) - 1);
+        acc1 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, a + i), _mm512_maskz_loadu_ps(mask, b + i), acc1);
+    }
+    return _mm512_reduce_add_ps(_mm512_add_ps(acc0, acc1));
+}
+
+__attribute__((target("avx512f")))
+static inline float l2SquaredAvx512(const float* a, const float* b, size_t dim) {
+    __m512 acc0 = _mm512_setzero_ps();
+    __m512 acc1 = _mm512_setzero_ps();
+    size_t i = 0;
+    for (; i + 32 <= dim; i += 32) {
+        __m512 d0 = _mm512_sub_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i));
+        __m512 d1 = _mm512_sub_ps(_mm512_loadu_ps(a + i + 16), _mm512_loadu_ps(b + i + 16));
+        acc0 = _mm512_fmadd_ps(d0, d0, acc0);
+        acc1 = _mm512_fmadd_ps(d1, d1, acc1);
+    }
+    for (; i + 16 <= dim; i += 16) {
+        __m512 d0 = _mm512_sub_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i));
+        acc0 = _mm512_fmadd_ps(d0, d0, acc0);
+    }
+    if (i < dim) {
+        __mmask16 mask = (__mmask16)((1u << (dim - i)) - 1);
+        __m512 d = _mm512_sub_ps(_mm512_maskz_loadu_ps(mask, a + i), _mm512_maskz_loadu_ps(mask, b + i));
+        acc1 = _mm512_fmadd_ps(d, d, acc1);
+    }
+    return _mm512_reduce_add_ps(_mm512_add_ps(acc0, acc1));
+}
+
+__attribute__((target("avx512f")))
+static float innerProductAvx512Entry(const float* a, const float* b, size_t dim) {
+    return innerProductAvx512(a, b, dim);
+}
+
+__attribute__((target("avx512f")))
+static float l2SquaredAvx512Entry(const float* a, const float* b, size_t dim) {
+    return l2SquaredAvx512(a, b, dim);
+}
+
+__attribute__((target("avx512f")))
+static void innerProductBatchAvx512(const float* query, const float* rows, size_t count, size_t dim, float* out) {
+    for (size_t r = 0; r < count; ++r) {
+        out[r] = innerProductAvx512(query, rows + r * dim, dim);
+    }
+}
+
+__attribute__((target("avx512f")))
+static void l2SquaredBatchAvx512(const float* query, const float* rows, size_t count, size_t dim, float* out) {
+    for (size_t r = 0; r < count; ++r) {
+        out[r] = l2SquaredAvx512(query, rows + r * dim, dim);
+    }
+}
+
+// One 16-wide gather per sub-quantizer covers one block
+__attribute__((target("avx512f")))
+static void pqLookupBlocksAvx512(const float* lut, const uint8_t* codes, size_t blocks, size_t m, float* out) {
+    for (size_t b = 0; b < blocks; ++b) {
+        __m512 acc0 = _mm512_setzero_ps();
+        __m512 acc1 = _mm512_setzero_ps();
+        size_t sub = 0;
+        for (; sub + 2 <= m; sub += 2) {
+            __m128i code0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(codes + sub * PQ_BLOCK));
+            __m128i code1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(codes + (sub + 1) * PQ_BLOCK));
+            acc0 = _mm512_add_ps(acc0, _mm512_i32gather_ps(_mm512_cvtepu8_epi32(code0), lut + sub * PQ_KSUB, 4));
+            acc1 = _mm512_add_ps(acc1, _mm512_i32gather_ps(_mm512_cvtepu8_epi32(code1), lut + (sub + 1) * PQ_KSUB, 4));
+        }
+        if (sub < m) {
+            __m128i code = _mm_loadu_si128(reinterpret_cast<const __m128i*>(codes + sub * PQ_BLOCK));
+            acc0 = _mm512_add_ps(acc0, _mm512_i32gather_ps(_mm512_cvtepu8_epi32(code), lut + sub * PQ_KSUB, 4));
+        }
+        _mm512_storeu_ps(out + b * PQ_BLOCK, _mm512_add_ps(acc0, acc1));
+        codes += m * PQ_BLOCK;
+    }
+}
+
+// VNNI's dpbusd multiplies unsigned by signed bytes, so bias the query:
+// (q + 128) . r - 128 * sum(r) == q . r
+__attribute__((target("avx512f,avx512bw,avx512vnni")))
+static void int8DotBatchVnni(const int8_t* query, const int8_t* rows, size_t count, size_t dim, int32_t* out) {
+    const __m512i bias = _mm512_set1_epi8(static_cast<char>(0x80));
+    for (size_t r = 0; r < count; ++r) {
+        const int8_t* row = rows + r * dim;
+        __m512i dot = _mm512_setzero_si512();
+        __m512i rowSum = _mm512_setzero_si512();
+        for (size_t i = 0; i < dim; i += 64) {
+            __mmask64 mask = i + 64 <= dim ? ~__mmask64(0) : (__mmask64(1) << (dim - i)) - 1;
+            __m512i q = _mm512_xor_si512(_mm512_maskz_loadu_epi8(mask, query + i), bias);
+            __m512i v = _mm512_maskz_loadu_epi8(mask, row + i);
+            dot = _mm512_dpbusd_epi32(dot, q, v);
+            rowSum = _mm512_dpbusd_epi32(rowSum, bias, v);
+        }
+        out[r] = _mm512_reduce_add_epi32(dot) - _mm512_reduce_add_epi32(rowSum);
+    }
+}
+
+__attribute__((target("avx512f")))
+static void fp16InnerProductBatchAvx512(const float* query, const uint16_t* rows, size_t count, size_t dim, float* out) {
+    for (size_t r = 0; r < count; ++r) {
+        const uint16_t* row = rows + r * dim;
+        __m512 acc0 = _mm512_setzero_ps();
+        __m512 acc1 = _mm512_setzero_ps();
+        size_t i = 0;
+        for (; i + 32 <= dim; i += 32) {
+            __m512 v0 = _mm512_cvtph_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + i)));
+            __m512 v1 = _mm512_cvtph_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + i + 16)));
+            acc0 = _mm512_fmadd_ps(_mm512_loadu_ps(query + i), v0, acc0);
+            acc1 = _mm512_fmadd_ps(_mm512_loadu_ps(query + i + 16), v1, acc1);
+        }
+        for (; i + 16 <= dim; i += 16) {
+            __m512 v0 = _mm512_cvtph_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + i)));
+            acc0 = _mm512_fmadd_ps(_mm512_loadu_ps(query + i), v0, acc0);
+        }
+        float sum = _mm512_reduce_add_ps(_mm512_add_ps(acc0, acc1));
+        for (; i < dim; ++i) sum += query[i] * halfToFloat(row[i]);
+        out[r] = sum;
+    }
+}
+
+__attribute__((target("avx512f")))
+static void fp16L2SquaredBatchAvx512(const float* query, const uint16_t* rows, size_t count, size_t dim, float* out) {
+    for (size_t r = 0; r < count; ++r) {
+        const uint16_t* row = rows + r * dim;
+        __m512 acc0 = _mm512_setzero_ps();
+        __m512 acc1 = _mm512_setzero_ps();
+        size_t i = 0;
+        for (; i + 32 <= dim; i += 32) {
+            __m512 d0 = _mm512_sub_ps(_mm512_loadu_ps(query + i),
+                                      _mm512_cvtph_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + i))));
+            __m512 d1 = _mm512_sub_ps(_mm512_loadu_ps(query + i + 16),
+                                      _mm512_cvtph_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + i + 16))));
+            acc0 = _mm512_fmadd_ps(d0, d0, acc0);
+            acc1 = _mm512_fmadd_ps(d1, d1, acc1);
+        }
+        for (; i + 16 <= dim; i += 16) {
+            __m512 d0 = _mm512_sub_ps(_mm512_loadu_ps(query + i),
+                                      _mm512_cvtph_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + i))));
+            acc0 = _mm512_fmadd_ps(d0, d0, acc0);
+        }
+        float sum = _mm512_reduce_add_ps(_mm512_add_ps(acc0, acc1));
+        for (; i < dim; ++i) {
+            float d = query[i] - halfToFloat(row[i]);
+            sum += d * d;
+        }
+        out[r] = sum;
+    }
+}
+
+// Eight words per step; masked loads cover codes that are not a multiple of
+// 512 bits (a 256-dim code is four words)
+__attribute__((target("avx512f,avx512vpopcntdq")))
+static void hammingBatchAvx512(const uint64_t* query, const uint64_t* codes, size_t count, size_t words, uint32_t* out) {
+    for (size_t r = 0; r < count; ++r) {
+        const uint64_t* code = codes + r * words;
+        __m512i acc = _mm512_setzero_si512();
+        for (size_t w = 0; w < words; w += 8) {
+            __mmask8 mask = w + 8 <= words ? __mmask8(0xff) : __mmask8((1u << (words - w)) - 1);
+            __m512i diff = _mm512_xor_si512(_mm512_maskz_loadu_epi64(mask, query + w),
+                                            _mm512_maskz_loadu_epi64(mask, code + w));
+            acc = _mm512_add_epi64(acc, _mm512_popcnt_epi64(diff));
+        }
+        out[r] = static_cast<uint32_t>(_mm512_reduce_add_epi64(acc));
+    }
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+#endif // MIMIR_X86_KERNELS
+
+static DistanceKernels resolveKernels() {
+    DistanceKernels kernels = {"scalar", innerProductScalar, l2SquaredScalar,
+                               innerProductBatchScalar, l2SquaredBatchScalar, pqLookupBlocksScalar,
+                               int8DotBatchScalar, fp16InnerProductBatchScalar, fp16L2SquaredBatchScalar,
+                               hammingBatchScalar};
+#ifdef MIMIR_X86_KERNELS
+    __builtin_cpu_init();
+    bool avx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    if (__builtin_cpu_supports("avx512f")) {
+        kernels = {"avx512", innerProductAvx512Entry, l2SquaredAvx512Entry,
+                   innerProductBatchAvx512, l2SquaredBatchAvx512, pqLookupBlocksAvx512,
+                   int8DotBatchScalar, fp16InnerProductBatchAvx512, fp16L2SquaredBatchAvx512,
+                   hammingBatchScalar};
+    } else if (avx2) {
+        kernels = {"avx2", innerProductAvx2Entry, l2SquaredAvx2Entry,
+                   innerProductBatchAvx2, l2SquaredBatchAvx2, pqLookupBlocksAvx2,
+                   int8DotBatchScalar, fp16InnerProductBatchScalar, fp16L2SquaredBatchScalar,
+                   hammingBatchScalar};
+        if (__builtin_cpu_supports("f16c")) {
+            kernels.fp16InnerProductBatch = fp16InnerProductBatchF16c;
+            kernels.fp16L2SquaredBatch = fp16L2SquaredBatchF16c;
+        }
+    }
+
+    // Integer and bit kernels depend on extensions that vary within a family
+    if (__builtin_cpu_supports("avx512vnni") && __builtin_cpu_supports("avx512bw")) {
+        kernels.int8DotBatch = int8DotBatchVnni;
+    } else if (avx2) {
+        kernels.int8DotBatch = int8DotBatchAvx2;
+    }
+    if (__builtin_cpu_supports("avx512vpopcntdq")) {
+        kernels.hammingBatch = hammingBatchAvx512;
+    } else if (__builtin_cpu_supports("popcnt")) {
+        kernels.hammingBatch = hammingBatchPopcnt;
+    }
+#endif
+    return kernels;
+}
+
+const DistanceKernels& distanceKernels() {
+    static const DistanceKernels kernels = resolveKernels();
+    return kernels;
+}
@@ -0,0 +1,50 @@
+#ifndef DISTANCE_KERNELS_H
+#define DISTANCE_KERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Product-quantizer codes are scanned in blocks of PQ_BLOCK vectors stored
+// sub-quantizer-major: block[m * PQ_BLOCK + j] is code m of vector j. One
+// SIMD load then yields code m for the whole block.
+constexpr size_t PQ_BLOCK = 16;
+constexpr size_t PQ_KSUB = 256;     // 8-bit codes
+
+// Distance kernels for float32 and quantized vectors. The best implementation
+// for the running CPU (AVX-512, AVX2+FMA or portable scalar; VNNI, F16C and
+// POPCNT / VPOPCNTDQ where present) is picked once at first use, so the binary stays runnable
+// on any x86-64 machine and on ARM.
+struct DistanceKernels {
+    const char* name;
+
+    float (*innerProduct)(const float* a, const float* b, size_t dim);
+    float (*l2Squared)(const float* a, const float* b, size_t dim);
+
+    // Score one query against `count` contiguous rows of a row-major matrix
+    void (*innerProductBatch)(const float* query, const float* rows, size_t count, size_t dim, float* out);
+    void (*l2SquaredBatch)(const float* query, const float* rows, size_t count, size_t dim, float* out);
+
+    // Asymmetric distance: out[b * PQ_BLOCK + j] = sum over m of
+    // lut[m * PQ_KSUB + code], for every vector j of `blocks` code blocks
+    void (*pqLookupBlocks)(const float* lut, const uint8_t* codes, size_t blocks, size_t m, float* out);
+
+    // Exact int32 dot products of an int8 query against `count` int8 rows.
+    // Values must lie in [-127, 127].
+    void (*int8DotBatch)(const int8_t* query, const int8_t* rows, size_t count, size_t dim, int32_t* out);
+
+    // Float query against rows stored as IEEE half precision
+    void (*fp16InnerProductBatch)(const float* query, const uint16_t* rows, size_t count, size_t dim, float* out);
+    void (*fp16L2SquaredBatch)(const float* query, const uint16_t* rows, size_t count, size_t dim, float* out);
+
+    // Hamming distances between a binary code and `count` contiguous codes
+    // of `words` 64-bit words each
+    void (*hammingBatch)(const uint64_t* query, const uint64_t* codes, size_t count, size_t words, uint32_t* out);
+};
+
+const DistanceKernels& distanceKernels();
+
+// Portable IEEE half <-> float conversion (round to nearest even)
+uint16_t floatToHalf(float value);
+float halfToFloat(uint16_t value);
+
+#endif // DISTANCE_KERNELS_H
@@ -0,0 +1,213 @@
+#include "EmbeddingMatrix.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+MapAdvice mapAdviceFromString(const string& value) {
+    if (value == "sequential") return MapAdvice::Sequential;
+    if (value == "random") return MapAdvice::Random;
+    if (value == "willneed") return MapAdvice::WillNeed;
+    return MapAdvice::Normal;
+}
+
+EmbeddingMatrix::~EmbeddingMatrix() {
+    releaseBuffer();
+}
+
+EmbeddingMatrix::EmbeddingMatrix(const EmbeddingMatrix& other) {
+    *this = other;
+}
+
+EmbeddingMatrix& EmbeddingMatrix::operator=(const EmbeddingMatrix& other) {
+    if (this != &other) {
+        resize(other.rowCount, other.dim);
+        if (rowCount > 0) {
+            memcpy(data, other.data, rowCount * rowStride * sizeof(float));
+        }
+    }
+    return *this;
+}
+
+void EmbeddingMatrix::swap(EmbeddingMatrix& other) {
+    std::swap(data, other.data);
+    std::swap(mapping, other.mapping);
+    std::swap(mappingBytes, other.mappingBytes);
+    std::swap(dim, other.dim);
+    std::swap(rowStride, other.rowStride);
+    std::swap(rowCount, other.rowCount);
+    std::swap(capacity, other.capacity);
+}
+
+void EmbeddingMatrix::releaseBuffer() {
+    if (mapping) {
+        munmap(mapping, mappingBytes);
+        mapping = nullptr;
+        mappingBytes = 0;
+    } else {
+        free(data);
+    }
+    data = nullptr;
+}
+
+void EmbeddingMatrix::clear() {
+    releaseBuffer();
+    dim = 0;
+    rowStride = 0;
+    rowCount = 0;
+    capacity = 0;
+}
+
+void EmbeddingMatrix::setDimension(size_t vecDim) {
+    dim = vecDim;
+    rowStride = (vecDim + 15) / 16 * 16;
+}
+
+bool EmbeddingMatrix::grow(size_t minRows) {
+    if (minRows <= capacity) {
+        return true;
+    }
+    size_t newCapacity = max(minRows, capacity * 2);
+    // rowStride is a multiple of 16 floats, so the size is a multiple of 64
+    float* newData = static_cast<float*>(aligned_alloc(ALIGNMENT, newCapacity * rowStride * sizeof(float)));
+    if (!newData) {
+        return false;
+    }
+    // A mapping has capacity 0, so the first append copies it out here
+    if (data) {
+        memcpy(newData, data, rowCount * rowStride * sizeof(float));
+        releaseBuffer();
+    }
+    data = newData;
+    capacity = newCapacity;
+    return true;
+}
+
+void EmbeddingMatrix::reserve(size_t rows, size_t vecDim) {
+    if (rowCount == 0 && vecDim != dim) {
+        clear();
+        setDimension(vecDim);
+    }
+    if (vecDim == dim && vecDim > 0) {
+        grow(rows);
+    }
+}
+
+bool EmbeddingMatrix::append(const float* vec, size_t vecDim) {
+    if (vecDim == 0) {
+        return false;
+    }
+    if (rowCount == 0 && vecDim != dim) {
+        clear();
+        setDimension(vecDim);
+    }
+    if (vecDim != dim || !grow(rowCount + 1)) {
+        return false;
+    }
+    float* dst = row(rowCount);
+    copy(vec, vec + dim, dst);
+    fill(dst + dim, dst + rowStride, 0.0f);
+    ++rowCount;
+    return true;
+}
+
+void EmbeddingMatrix::resize(size_t rows, size_t vecDim) {
+    clear();
+    if (rows == 0 || vecDim == 0) {
+        return;
+    }
+    setDimension(vecDim);
+    if (grow(rows)) {
+        memset(data, 0, rows * rowStride * sizeof(float));
+        rowCount = rows;
+    }
+}
+
+bool EmbeddingMatrix::write(ostream& out) const {
+    // Without padding the buffer is already the file layout
+    if (rowStride == dim) {
+        out.write(reinterpret_cast<const char*>(data), rowCount * dim * sizeof(float));
+    } else {
+        for (size_t r = 0; r < rowCount; ++r) {
+            out.write(reinterpret_cast<const char*>(row(r)), dim * sizeof(float));
+        }
+    }
+    return static_cast<bool>(out);
+}
+
+bool EmbeddingMatrix::read(istream& in, size_t rows, size_t vecDim) {
+    resize(rows, vecDim);
+    if (rowCount != rows && rows > 0 && vecDim > 0) {
+        clear();
+        return false;
+    }
+
+    bool ok = true;
+    if (rowStride == dim) {
+        ok = static_cast<bool>(in.read(reinterpret_cast<char*>(data), rowCount * dim * sizeof(float)));
+    } else {
+        for (size_t r = 0; r < rowCount && ok; ++r) {
+            ok = static_cast<bool>(in.read(reinterpret_cast<char*>(row(r)), dim * sizeof(float)));
+        }
+    }
+    if (!ok) {
+        clear();
+        return false;
+    }
+    return true;
+}
+
+bool EmbeddingMatrix::map(const string& filePath, uint64_t offset, size_t rows, size_t vecDim,
+                          bool populate, MapAdvice advice) {
+    clear();
+    if (rows == 0 || vecDim == 0 || vecDim % 16 != 0 || offset % ALIGNMENT != 0) {
+        return false;
+    }
+    int fd = open(filePath.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat info;
+    size_t rowBytes = rows * vecDim * sizeof(float);
+    if (fstat(fd, &info) != 0 || static_cast<uint64_t>(info.st_size) < offset ||
+        (static_cast<uint64_t>(info.st_size) - offset) / (vecDim * sizeof(float)) < rows) {
+        close(fd);
+        return false;
+    }
+
+    // mmap() wants a page-aligned file offset, so map from the page holding the rows
+    uint64_t pageSize = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+    uint64_t mapStart = offset - offset % pageSize;
+    size_t bytes = static_cast<size_t>(offset - mapStart) + rowBytes;
+    int flags = MAP_SHARED;
+#ifdef MAP_POPULATE
+    if (populate) flags |= MAP_POPULATE;    // Fault every page in now rather than on first touch
+#else
+    (void)populate;
+#endif
+    void* base = mmap(nullptr, bytes, PROT_READ, flags, fd, static_cast<off_t>(mapStart));
+    close(fd);
+    if (base == MAP_FAILED) {
+        return false;
+    }
+
+    int hint = MADV_NORMAL;
+    if (advice == MapAdvice::Sequential) hint = MADV_SEQUENTIAL;
+    else if (advice == MapAdvice::Random) hint = MADV_RANDOM;
+    else if (advice == MapAdvice::WillNeed) hint = MADV_WILLNEED;
+    madvise(base, bytes, hint);
+
+    // The offset is a multiple of 64 and rows are whole cache lines, so
+    // every row keeps cache-line alignment inside the page-aligned mapping
+    mapping = base;
+    mappingBytes = bytes;
+    data = reinterpret_cast<float*>(static_cast<char*>(base) + (offset - mapStart));
+    setDimension(vecDim);
+    rowCount = rows;
+    capacity = 0;
+    return true;
+}
@@ -0,0 +1,89 @@
+#ifndef EMBEDDING_MATRIX_H
+#define EMBEDDING_MATRIX_H
+
+#include <string>
+#include <iostream>
+#include <cstdint>
+#include <cstddef>
+
+using namespace std;
+
+// One contiguous, 64-byte-aligned row-major float matrix: the rows of the
+// flat index, and so the session's only full-precision copy of its
+// embeddings (row = chunk's embedding_row). Rows are padded to a multiple of
+// 16 floats so each row starts on a cache line and SIMD loads never split
+// one.
+//
+// The matrix has no file of its own: the owning index writes and reads the
+// unpadded rows as one block of its index file. When the rows need no
+// padding that block can instead be mapped read-only where it lies: opening
+// is then O(1), pages come from the kernel page cache and are shared between
+// processes, and the first modification copies the rows into an owned buffer.
+
+// madvise() hint for a mapped matrix (session.mmap_advice)
+enum class MapAdvice {
+    Normal,
+    Sequential,     // Scans: aggressive read-ahead
+    Random,         // Point lookups: no read-ahead
+    WillNeed        // Start reading everything in the background
+};
+
+MapAdvice mapAdviceFromString(const string& value);
+
+class EmbeddingMatrix {
+public:
+    static const size_t ALIGNMENT = 64;
+
+    EmbeddingMatrix() = default;
+    ~EmbeddingMatrix();
+
+    // Deep copies of the aligned buffer
+    EmbeddingMatrix(const EmbeddingMatrix& other);
+    EmbeddingMatrix& operator=(const EmbeddingMatrix& other);
+    void swap(EmbeddingMatrix& other);
+
+    size_t rows() const { return rowCount; }
+    size_t dimension() const { return dim; }
+    size_t stride() const { return rowStride; }
+    bool empty() const { return rowCount == 0; }
+    bool isMapped() const { return mapping != nullptr; }
+
+    // Grows the buffer once for `rows` rows of vecDim floats; ignored if
+    // rows of another dimension are already stored
+    void reserve(size_t rows, size_t vecDim);
+    // Appends one row; the first row fixes the dimension
+    bool append(const float* vec, size_t vecDim);
+    // Sets the dimension and `rows` zeroed rows to be filled through row()
+    void resize(size_t rows, size_t vecDim);
+
+    const float* row(size_t index) const { return data + index * rowStride; }
+    // Not for mapped rows, which are read-only; resize() and append() copy them
+    float* row(size_t index) { return data + index * rowStride; }
+
+    void clear();
+
+    // Writes the rows unpadded, as one row-major float block
+    bool write(ostream& out) const;
+    // Replaces the matrix with `rows` unpadded rows of vecDim floats from in
+    bool read(istream& in, size_t rows, size_t vecDim);
+    // Maps `rows` unpadded rows of vecDim floats at `offset` in filePath;
+    // fails (leaving the matrix empty) if the file is too short, the rows
+    // would need padding or the offset is not 64-byte aligned
+    bool map(const string& filePath, uint64_t offset, size_t rows, size_t vecDim,
+             bool populate, MapAdvice advice);
+
+private:
+    float* data = nullptr;          // Owned buffer, or rows inside mapping
+    void* mapping = nullptr;
+    size_t mappingBytes = 0;
+    size_t dim = 0;
+    size_t rowStride = 0;           // dim rounded up to 16 floats
+    size_t rowCount = 0;
+    size_t capacity = 0;            // Rows allocated
+
+    void setDimension(size_t vecDim);
+    bool grow(size_t minRows);
+    void releaseBuffer();
+};
+
+#endif // EMBEDDING_MATRIX_H
@@ -0,0 +1,160 @@
+#include "FlatIndex.h"
+#include "DistanceKernels.h"
+#include <fstream>
+#include <cstdio>
+#include <algorithm>
+
+FlatIndex::FlatIndex(size_t dim, MetricType metric)
+    : dim(dim), metric(metric) {}
+
+bool FlatIndex::add(const string& id, const float* embedding, size_t embeddingDim) {
+    if (embedding == nullptr || embeddingDim == 0) {
+        return false;
+    }
+    if (ids.empty()) {
+        // The first vector fixes the dimension; the configured dim is only a hint
+        // because the server may return untruncated embeddings
+        dim = embeddingDim;
+    }
+    if (embeddingDim != dim) {
+        cout << "⚠️  Embedding for '" << id << "' has dimension " << embeddingDim
+             << ", index expects " << dim << ". Skipping.\n";
+        return false;
+    }
+
+    if (!vectors.append(embedding, dim)) {
+        return false;
+    }
+    if (usesPrefixSearch()) {
+        prefixVectors.insert(prefixVectors.end(), embedding, embedding + prefixDim);
+    }
+    ids.push_back(id);
+    return true;
+}
+
+void FlatIndex::clear() {
+    vectors.clear();
+    prefixVectors.clear();
+    ids.clear();
+}
+
+void FlatIndex::setMapping(bool enabled, bool populate, MapAdvice advice) {
+    mapRows = enabled;
+    mapPopulate = populate;
+    mapAdvice = advice;
+}
+
+void FlatIndex::setPrefixSearch(size_t value, size_t shortlistSize) {
+    prefixDim = value;
+    shortlist = shortlistSize;
+    rebuildPrefixVectors();
+}
+
+void FlatIndex::rebuildPrefixVectors() {
+    vector<float>().swap(prefixVectors);
+    if (!usesPrefixSearch()) {
+        return;
+    }
+    prefixVectors.resize(ids.size() * prefixDim);
+    for (size_t row = 0; row < ids.size(); ++row) {
+        copy(vectorAt(row), vectorAt(row) + prefixDim, &prefixVectors[row * prefixDim]);
+    }
+}
+
+bool FlatIndex::reconstruct(size_t row, float* out) const {
+    if (row >= ids.size()) {
+        return false;
+    }
+    copy(vectorAt(row), vectorAt(row) + dim, out);
+    return true;
+}
+
+vector<SearchResult> FlatIndex::searchVectors(const float* query, size_t k,
+                                              const SearchParams& params) const {
+    (void)params;
+    size_t count = ids.size();
+    if (!usesPrefixSearch() || max(k, shortlist) >= count) {
+        TopK heap(min(k, count));
+        scanVectors(query, vectors.row(0), count, dim, metric, nullptr, 0, heap, vectors.stride());
+        return collectResults(heap, metric, *this);
+    }
+
+    // First pass over the packed prefixes, then exact scores for the shortlist
+    TopK candidates(max(k, shortlist));
+    scanVectors(query, prefixVectors.data(), count, prefixDim, metric, nullptr, 0, candidates);
+
+    const DistanceKernels& kernels = distanceKernels();
+    bool l2 = metric == MetricType::L2;
+    TopK heap(k);
+    for (const auto& candidate : candidates.takeSorted()) {
+        const float* row = vectorAt(candidate.second);
+        float score = l2 ? -kernels.l2Squared(query, row, dim) : kernels.innerProduct(query, row, dim);
+        heap.push(score, candidate.second);
+    }
+    return collectResults(heap, metric, *this);
+}
+
+bool FlatIndex::save(const string& filePath) const {
+    if (vectors.isMapped() && filePath == mappedPath) {
+        // Still the unmodified mapping of this very file
+        return true;
+    }
+    string tempPath = filePath + ".tmp";
+    ofstream file(tempPath, ios::binary | ios::trunc);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    IndexFileHeader header = makeIndexHeader(IndexType::Flat, metric, dim, ids.size());
+    header.id_bytes = idTableBytes(ids);
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    vectors.write(file);
+    writeIdTable(file, ids);
+    file.close();
+
+    if (!file) {
+        remove(tempPath.c_str());
+        return false;
+    }
+    return commitIndexFile(tempPath, filePath);
+}
+
+bool FlatIndex::load(const string& filePath) {
+    ifstream file(filePath, ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    IndexFileHeader header;
+    if (!readIndexHeader(file, header) ||
+        header.index_type != static_cast<uint32_t>(IndexType::Flat) ||
+        !indexBodyFits(file, header, uint64_t(header.dim) * sizeof(float))) {
+        return false;
+    }
+
+    // Map the matrix where it lies or read it directly into place, then
+    // read the id table behind it
+    EmbeddingMatrix loadedVectors;
+    bool mapped = mapRows && header.count > 0 &&
+                  loadedVectors.map(filePath, sizeof(header), header.count, header.dim,
+                                    mapPopulate, mapAdvice);
+    if (mapped) {
+        file.seekg(sizeof(header) + header.count * header.dim * sizeof(float));
+    } else if (!loadedVectors.read(file, header.count, header.dim)) {
+        return false;
+    }
+
+    vector<string> loadedIds;
+    if (!readIdTable(file, header.count, header.id_bytes, loadedIds)) {
+        return false;
+    }
+
+    dim = header.dim;
+    metric = static_cast<MetricType>(header.metric);
+    vectors.swap(loadedVectors);
+    ids.swap(loadedIds);
+    mappedPath = mapped ? filePath : string();
+    rebuildPrefixVectors();
+    return true;
+}
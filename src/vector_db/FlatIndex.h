@@ -0,0 +1,71 @@
+#ifndef FLAT_INDEX_H
+#define FLAT_INDEX_H
+
+#include <string>
+#include <vector>
+#include "VectorIndex.h"
+#include "EmbeddingMatrix.h"
+
+using namespace std;
+
+// Exact index: every embedding is kept as one row of an aligned row-major
+// EmbeddingMatrix, with a parallel table of chunk ids. This matrix is the
+// session's only in-memory copy of the vectors. With mapping enabled,
+// load() maps the matrix block of the index file instead of reading it.
+//
+// Optional two-stage (Matryoshka) search: with a prefix dimension set, the
+// leading prefixDim components of each row are also packed into a second
+// matrix. Queries scan that matrix first and re-score the best
+// max(k, shortlist) rows on all dimensions. Only useful with models trained
+// so that truncated embeddings stay meaningful (truncate_dim).
+class FlatIndex : public VectorIndex {
+public:
+    FlatIndex(size_t dim = 0, MetricType metric = MetricType::InnerProduct);
+
+    using VectorIndex::add;
+    bool add(const string& id, const float* embedding, size_t embeddingDim) override;
+    void clear() override;
+
+    size_t size() const override { return ids.size(); }
+    size_t dimension() const override { return dim; }
+    MetricType getMetric() const override { return metric; }
+    IndexType getType() const override { return IndexType::Flat; }
+
+    const string& idAt(size_t row) const override { return ids[row]; }
+    bool reconstruct(size_t row, float* out) const override;
+    const float* vectorAt(size_t row) const { return vectors.row(row); }
+
+    // prefixDim 0 (or >= the vector dimension) searches all dimensions at once
+    void setPrefixSearch(size_t prefixDim, size_t shortlist);
+    bool usesPrefixSearch() const { return prefixDim > 0 && prefixDim < dim; }
+
+    // session.mmap_embeddings / mmap_populate / mmap_advice, used by load()
+    void setMapping(bool enabled, bool populate, MapAdvice advice);
+
+    bool save(const string& filePath) const override;
+    bool load(const string& filePath) override;
+
+protected:
+    // Exact scan of the whole matrix in cache-sized blocks
+    vector<SearchResult> searchVectors(const float* query, size_t k,
+                                       const SearchParams& params) const override;
+
+private:
+    size_t dim;
+    MetricType metric;
+    EmbeddingMatrix vectors;
+    vector<string> ids;
+
+    bool mapRows = false;
+    bool mapPopulate = false;
+    MapAdvice mapAdvice = MapAdvice::Normal;
+    string mappedPath;              // File the rows are still mapped from
+
+    size_t prefixDim = 0;
+    size_t shortlist = 0;
+    vector<float> prefixVectors;    // count x prefixDim, derived from vectors
+
+    void rebuildPrefixVectors();
+};
+
+#endif // FLAT_INDEX_H
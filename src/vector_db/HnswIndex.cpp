@@ -0,0 +1,384 @@
+#include "HnswIndex.h"
+#include "DistanceKernels.h"
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <queue>
+#include <cmath>
+#include <cstdio>
+
+HnswIndex::HnswIndex(size_t dim, MetricType metric, size_t M, size_t efConstruction, size_t efSearch)
+    : dim(dim),
+      metric(metric),
+      M(max<size_t>(M, 2)),
+      maxM0(2 * max<size_t>(M, 2)),
+      efConstruction(max(efConstruction, max<size_t>(M, 2))),
+      efSearch(max<size_t>(efSearch, 1)),
+      levelMult(1.0 / log(double(max<size_t>(M, 2)))),
+      levelRng(4242) {}
+
+float HnswIndex::distance(const float* a, const float* b) const {
+    const DistanceKernels& kernels = distanceKernels();
+    if (metric == MetricType::L2) {
+        return kernels.l2Squared(a, b, dim);
+    }
+    return -kernels.innerProduct(a, b, dim);
+}
+
+uint32_t* HnswIndex::linksAt(uint32_t node, int level) {
+    if (level == 0) {
+        return &level0Links[size_t(node) * (maxM0 + 1)];
+    }
+    return &upperLinks[node][size_t(level - 1) * (M + 1)];
+}
+
+const uint32_t* HnswIndex::linksAt(uint32_t node, int level) const {
+    if (level == 0) {
+        return &level0Links[size_t(node) * (maxM0 + 1)];
+    }
+    return &upperLinks[node][size_t(level - 1) * (M + 1)];
+}
+
+int HnswIndex::randomLevel() {
+    uniform_real_distribution<double> uniform(0.0, 1.0);
+    double r = -log(max(uniform(levelRng), 1e-12)) * levelMult;
+    return min(static_cast<int>(r), 255);
+}
+
+uint32_t HnswIndex::nextVisitedEpoch() const {
+    if (visitedTags.size() < ids.size()) {
+        visitedTags.resize(ids.size(), 0);
+    }
+    if (++visitedEpoch == 0) {
+        fill(visitedTags.begin(), visitedTags.end(), 0);
+        visitedEpoch = 1;
+    }
+    return visitedEpoch;
+}
+
+uint32_t HnswIndex::greedyClosest(const float* query, uint32_t start, int level) const {
+    uint32_t current = start;
+    float currentDist = distance(query, vectorAt(current));
+    bool improved = true;
+    while (improved) {
+        improved = false;
+        const uint32_t* links = linksAt(current, level);
+        for (uint32_t i = 1; i <= links[0]; ++i) {
+            float d = distance(query, vectorAt(links[i]));
+            if (d < currentDist) {
+                currentDist = d;
+                current = links[i];
+                improved = true;
+            }
+        }
+    }
+    return current;
+}
+
+vector<HnswIndex::Candidate> HnswIndex::searchLayer(const float* query, uint32_t start,
+                                                    size_t ef, int level) const {
+    uint32_t epoch = nextVisitedEpoch();
+    priority_queue<Candidate, vector<Candidate>, greater<Candidate>> candidates;  // Closest on top
+    priority_queue<Candidate> results;                                          // Farthest on top
+
+    float startDist = distance(query, vectorAt(start));
+    candidates.emplace(startDist, start);
+    results.emplace(startDist, start);
+    visitedTags[start] = epoch;
+
+    while (!candidates.empty()) {
+        Candidate current = candidates.top();
+        if (current.first > results.top().first && results.size() >= ef) {
+            break;
+        }
+        candidates.pop();
+
+        const uint32_t* links = linksAt(current.second, level);
+        for (uint32_t i = 1; i <= links[0]; ++i) {
+            uint32_t neighbor = links[i];
+            if (visitedTags[neighbor] == epoch) continue;
+            visitedTags[neighbor] = epoch;
+
+            float d = distance(query, vectorAt(neighbor));
+            if (results.size() < ef || d < results.top().first) {
+                candidates.emplace(d, neighbor);
+                results.emplace(d, neighbor);
+                if (results.size() > ef) results.pop();
+            }
+        }
+    }
+
+    vector<Candidate> found(results.size());
+    for (size_t i = found.size(); i-- > 0;) {
+        found[i] = results.top();
+        results.pop();
+    }
+    return found;
+}
+
+// Neighbor selection heuristic from the HNSW paper: walk candidates from
+// closest outward and keep one only if it is closer to the base node than to
+// every neighbor already kept. Favors links in diverse directions over
+// redundant links into one cluster. Expects candidates sorted ascending.
+void HnswIndex::selectNeighbors(vector<Candidate>& candidates, size_t m) const {
+    if (candidates.size() <= m) {
+        return;
+    }
+    vector<Candidate> selected;
+    selected.reserve(m);
+    for (const Candidate& candidate : candidates) {
+        if (selected.size() >= m) break;
+        bool keep = true;
+        for (const Candidate& kept : selected) {
+            if (distance(vectorAt(candidate.second), vectorAt(kept.second)) < candidate.first) {
+                keep = false;
+                break;
+            }
+        }
+        if (keep) selected.push_back(candidate);
+    }
+    candidates.swap(selected);
+}
+
+void HnswIndex::connect(uint32_t node, int level, vector<Candidate> candidates) {
+    selectNeighbors(candidates, M);
+
+    uint32_t* links = linksAt(node, level);
+    links[0] = static_cast<uint32_t>(candidates.size());
+    for (size_t i = 0; i < candidates.size(); ++i) {
+        links[i + 1] = candidates[i].second;
+    }
+
+    size_t capacity = maxLinks(level);
+    for (const Candidate& candidate : candidates) {
+        uint32_t* neighborLinks = linksAt(candidate.second, level);
+        if (neighborLinks[0] < capacity) {
+            neighborLinks[++neighborLinks[0]] = node;
+            continue;
+        }
+
+        // Neighbor is full: re-select among its current links plus the new node
+        const float* base = vectorAt(candidate.second);
+        vector<Candidate> pool;
+        pool.reserve(capacity + 1);
+        pool.emplace_back(candidate.first, node);
+        for (uint32_t i = 1; i <= neighborLinks[0]; ++i) {
+            pool.emplace_back(distance(base, vectorAt(neighborLinks[i])), neighborLinks[i]);
+        }
+        sort(pool.begin(), pool.end());
+        selectNeighbors(pool, capacity);
+
+        neighborLinks[0] = static_cast<uint32_t>(pool.size());
+        for (size_t i = 0; i < pool.size(); ++i) {
+            neighborLinks[i + 1] = pool[i].second;
+        }
+    }
+}
+
+bool HnswIndex::add(const string& id, const float* embedding, size_t embeddingDim) {
+    if (embedding == nullptr || embeddingDim == 0) {
+        return false;
+    }
+    if (ids.empty()) {
+        // The first vector fixes the dimension; the configured dim is only a hint
+        dim = embeddingDim;
+    }
+    if (embeddingDim != dim) {
+        cout << "⚠️  Embedding for '" << id << "' has dimension " << embeddingDim
+             << ", index expects " << dim << ". Skipping.\n";
+        return false;
+    }
+
+    uint32_t node = static_cast<uint32_t>(ids.size());
+    int level = randomLevel();
+    ids.push_back(id);
+    vectors.insert(vectors.end(), embedding, embedding + dim);
+    levels.push_back(static_cast<uint8_t>(level));
+    level0Links.resize(level0Links.size() + maxM0 + 1, 0);
+    upperLinks.emplace_back(size_t(level) * (M + 1), 0);
+
+    if (maxLevel < 0) {
+        entryPoint = node;
+        maxLevel = level;
+        return true;
+    }
+
+    const float* query = vectorAt(node);
+    uint32_t current = entryPoint;
+    for (int l = maxLevel; l > level; --l) {
+        current = greedyClosest(query, current, l);
+    }
+    for (int l = min(level, maxLevel); l >= 0; --l) {
+        vector<Candidate> found = searchLayer(query, current, efConstruction, l);
+        current = found.front().second;
+        connect(node, l, found);
+    }
+
+    if (level > maxLevel) {
+        maxLevel = level;
+        entryPoint = node;
+    }
+    return true;
+}
+
+void HnswIndex::clear() {
+    maxLevel = -1;
+    entryPoint = 0;
+    vectors.clear();
+    ids.clear();
+    levels.clear();
+    level0Links.clear();
+    upperLinks.clear();
+    visitedTags.clear();
+    visitedEpoch = 0;
+}
+
+bool HnswIndex::reconstruct(size_t row, float* out) const {
+    if (row >= ids.size()) {
+        return false;
+    }
+    copy(vectorAt(row), vectorAt(row) + dim, out);
+    return true;
+}
+
+vector<SearchResult> HnswIndex::searchVectors(const float* query, size_t k,
+                                              const SearchParams& params) const {
+    size_t ef = max(params.efSearch > 0 ? params.efSearch : efSearch, k);
+
+    uint32_t current = entryPoint;
+    for (int l = maxLevel; l > 0; --l) {
+        current = greedyClosest(query, current, l);
+    }
+    vector<Candidate> found = searchLayer(query, current, ef, 0);
+
+    // Distances are "lower is closer"; the heap wants "higher is better"
+    TopK heap(min(k, found.size()));
+    for (const Candidate& candidate : found) {
+        heap.push(-candidate.first, candidate.second);
+    }
+    return collectResults(heap, metric, *this);
+}
+
+string HnswIndex::describe() const {
+    stringstream ss;
+    ss << VectorIndex::describe() << ", M " << M << ", efConstruction " << efConstruction
+       << ", efSearch " << efSearch;
+    return ss.str();
+}
+
+// Body layout after the common header
+// (params = M, efConstruction, maxLevel + 1, entryPoint):
+//   float vectors[count * dim]
+//   uint8 levels[count]
+//   uint32 level0Links[count * (2M + 1)]
+//   for each node with level > 0: uint32 links[level * (M + 1)]
+bool HnswIndex::save(const string& filePath) const {
+    string tempPath = filePath + ".tmp";
+    ofstream file(tempPath, ios::binary | ios::trunc);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    IndexFileHeader header = makeIndexHeader(IndexType::Hnsw, metric, dim, ids.size());
+    header.id_bytes = idTableBytes(ids);
+    header.params[0] = static_cast<uint32_t>(M);
+    header.params[1] = static_cast<uint32_t>(efConstruction);
+    header.params[2] = static_cast<uint32_t>(maxLevel + 1);
+    header.params[3] = entryPoint;
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    file.write(reinterpret_cast<const char*>(vectors.data()), vectors.size() * sizeof(float));
+    file.write(reinterpret_cast<const char*>(levels.data()), levels.size());
+    file.write(reinterpret_cast<const char*>(level0Links.data()), level0Links.size() * sizeof(uint32_t));
+    for (const auto& links : upperLinks) {
+        file.write(reinterpret_cast<const char*>(links.data()), links.size() * sizeof(uint32_t));
+    }
+    writeIdTable(file, ids);
+    file.close();
+
+    if (!file) {
+        remove(tempPath.c_str());
+        return false;
+    }
+    return commitIndexFile(tempPath, filePath);
+}
+
+bool HnswIndex::load(const string& filePath) {
+    ifstream file(filePath, ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    IndexFileHeader header;
+    if (!readIndexHeader(file, header) ||
+        header.index_type != static_cast<uint32_t>(IndexType::Hnsw) ||
+        header.params[0] < 2 ||
+        // Vector, level and level-0 links per node; upper links come on top
+        !indexBodyFits(file, header, uint64_t(header.dim) * sizeof(float) + 1 +
+                                         (2 * uint64_t(header.params[0]) + 1) * sizeof(uint32_t))) {
+        return false;
+    }
+
+    clear();
+    dim = header.dim;
+    metric = static_cast<MetricType>(header.metric);
+    M = header.params[0];
+    maxM0 = 2 * M;
+    efConstruction = header.params[1];
+    levelMult = 1.0 / log(double(M));
+    size_t count = header.count;
+
+    vectors.resize(count * dim);
+    levels.resize(count);
+    level0Links.resize(count * (maxM0 + 1));
+    bool ok = file.read(reinterpret_cast<char*>(vectors.data()), vectors.size() * sizeof(float)) &&
+              file.read(reinterpret_cast<char*>(levels.data()), levels.size()) &&
+              file.read(reinterpret_cast<char*>(level0Links.data()), level0Links.size() * sizeof(uint32_t));
+
+    upperLinks.resize(count);
+    for (size_t node = 0; ok && node < count; ++node) {
+        upperLinks[node].resize(size_t(levels[node]) * (M + 1));
+        if (!upperLinks[node].empty()) {
+            ok = static_cast<bool>(file.read(reinterpret_cast<char*>(upperLinks[node].data()),
+                                             upperLinks[node].size() * sizeof(uint32_t)));
+        }
+    }
+
+    if (!ok || !readIdTable(file, count, header.id_bytes, ids) ||
+        (count > 0 && header.params[3] >= count)) {
+        clear();
+        return false;
+    }
+    maxLevel = static_cast<int>(header.params[2]) - 1;
+    entryPoint = header.params[3];
+    if (!graphValid()) {
+        cout << "⚠️  HNSW graph in " << filePath << " links to missing nodes\n";
+        clear();
+        return false;
+    }
+    return true;
+}
+
+bool HnswIndex::graphValid() const {
+    size_t count = levels.size();
+    if (count == 0) {
+        return maxLevel == -1;
+    }
+    if (entryPoint >= count || maxLevel != int(levels[entryPoint])) {
+        return false;
+    }
+    for (size_t node = 0; node < count; ++node) {
+        for (int level = 0; level <= levels[node]; ++level) {
+            const uint32_t* links = linksAt(static_cast<uint32_t>(node), level);
+            if (links[0] > maxLinks(level)) {
+                return false;
+            }
+            for (uint32_t i = 1; i <= links[0]; ++i) {
+                if (links[i] >= count || levels[links[i]] < level) {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
@@ -0,0 +1,91 @@
+#ifndef HNSW_INDEX_H
+#define HNSW_INDEX_H
+
+#include <string>
+#include <vector>
+#include <random>
+#include <cstdint>
+#include "VectorIndex.h"
+
+using namespace std;
+
+// Hierarchical navigable small-world graph (IndexHNSWFlat). Each vector is a
+// node on level 0 and, with exponentially decreasing probability, on higher
+// levels; queries descend greedily from the top and finish with a best-first
+// search of width efSearch on level 0.
+//
+// Nodes are numbered by row, so vectors live in one contiguous matrix and the
+// level-0 adjacency (the bulk of the graph) is a flat array with a fixed
+// stride. Searches reuse a visited-tag buffer owned by the index, so they must
+// not run concurrently on the same instance.
+class HnswIndex : public VectorIndex {
+public:
+    HnswIndex(size_t dim, MetricType metric, size_t M, size_t efConstruction, size_t efSearch);
+
+    using VectorIndex::add;
+    bool add(const string& id, const float* embedding, size_t embeddingDim) override;
+    void clear() override;
+
+    size_t size() const override { return ids.size(); }
+    size_t dimension() const override { return dim; }
+    MetricType getMetric() const override { return metric; }
+    IndexType getType() const override { return IndexType::Hnsw; }
+
+    const string& idAt(size_t row) const override { return ids[row]; }
+    bool reconstruct(size_t row, float* out) const override;
+
+    size_t getM() const { return M; }
+    size_t getEfSearch() const { return efSearch; }
+    void setEfSearch(size_t value) { efSearch = value; }
+
+    bool save(const string& filePath) const override;
+    bool load(const string& filePath) override;
+
+    string describe() const override;
+
+protected:
+    vector<SearchResult> searchVectors(const float* query, size_t k,
+                                       const SearchParams& params) const override;
+
+private:
+    using Candidate = pair<float, uint32_t>;  // (distance, node), lower is closer
+
+    size_t dim;
+    MetricType metric;
+    size_t M;                   // Links per node on levels >= 1
+    size_t maxM0;               // Links per node on level 0 (2 * M)
+    size_t efConstruction;
+    size_t efSearch;
+    double levelMult;
+
+    int maxLevel = -1;
+    uint32_t entryPoint = 0;
+
+    vector<float> vectors;                  // Row-major, row = node
+    vector<string> ids;
+    vector<uint8_t> levels;                 // Top level of each node
+    vector<uint32_t> level0Links;           // Per node: [count, links[maxM0]]
+    vector<vector<uint32_t>> upperLinks;    // Per node: levels 1..top, each [count, links[M]]
+
+    mt19937 levelRng;
+    mutable vector<uint32_t> visitedTags;
+    mutable uint32_t visitedEpoch = 0;
+
+    const float* vectorAt(uint32_t node) const { return vectors.data() + size_t(node) * dim; }
+    float distance(const float* a, const float* b) const;
+    size_t maxLinks(int level) const { return level == 0 ? maxM0 : M; }
+    uint32_t* linksAt(uint32_t node, int level);
+    const uint32_t* linksAt(uint32_t node, int level) const;
+    // After load: every link is a node that exists on that level, and the
+    // entry point sits on the top level, so search never reads out of bounds
+    bool graphValid() const;
+
+    int randomLevel();
+    uint32_t nextVisitedEpoch() const;
+    uint32_t greedyClosest(const float* query, uint32_t start, int level) const;
+    vector<Candidate> searchLayer(const float* query, uint32_t start, size_t ef, int level) const;
+    void selectNeighbors(vector<Candidate>& candidates, size_t m) const;
+    void connect(uint32_t node, int level, vector<Candidate> candidates);
+};
+
+#endif // HNSW_INDEX_H
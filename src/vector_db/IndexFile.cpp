@@ -0,0 +1,159 @@
+#include "IndexFile.h"
+#include <cstring>
+#include <cstdio>
+
+static const char INDEX_MAGIC[8] = {'M', 'I', 'M', 'I', 'R', 'I', 'D', 'X'};
+
+MetricType metricFromConfig(const VectorDbConfig& config) {
+    // The index type name wins over the metric field when they disagree
+    if (config.index_type == "IndexFlatL2") return MetricType::L2;
+    if (config.index_type == "IndexFlatIP") return MetricType::InnerProduct;
+    if (config.metric == "l2") return MetricType::L2;
+    return MetricType::InnerProduct;
+}
+
+string metricToString(MetricType metric) {
+    return metric == MetricType::L2 ? "l2" : "inner_product";
+}
+
+IndexType indexTypeFromConfig(const VectorDbConfig& config) {
+    if (config.index_type == "IndexIVFFlat") return IndexType::IvfFlat;
+    if (config.index_type == "IndexHNSWFlat") return IndexType::Hnsw;
+    if (config.index_type == "IndexIVFPQ") return IndexType::IvfPq;
+    if (config.index_type == "IndexBinaryFlat") return IndexType::Binary;
+    return IndexType::Flat;
+}
+
+string indexTypeToString(IndexType type) {
+    switch (type) {
+        case IndexType::IvfFlat: return "IndexIVFFlat";
+        case IndexType::Hnsw: return "IndexHNSWFlat";
+        case IndexType::IvfPq: return "IndexIVFPQ";
+        case IndexType::ScalarQuantized: return "IndexScalarQuantizer";
+        case IndexType::Binary: return "IndexBinaryFlat";
+        case IndexType::Flat: break;
+    }
+    return "IndexFlat";
+}
+
+ScalarQuantization quantizationFromConfig(const EmbeddingConfig& config) {
+    if (config.quantization == "fp16") return ScalarQuantization::Fp16;
+    if (config.quantization == "int8") return ScalarQuantization::Int8;
+    return ScalarQuantization::None;
+}
+
+string quantizationToString(ScalarQuantization quantization) {
+    switch (quantization) {
+        case ScalarQuantization::Fp16: return "fp16";
+        case ScalarQuantization::Int8: return "int8";
+        case ScalarQuantization::None: break;
+    }
+    return "float32";
+}
+
+IndexFileHeader makeIndexHeader(IndexType type, MetricType metric, size_t dim, size_t count) {
+    IndexFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC));
+    header.version = INDEX_FILE_VERSION;
+    header.index_type = static_cast<uint32_t>(type);
+    header.metric = static_cast<uint32_t>(metric);
+    header.dim = static_cast<uint32_t>(dim);
+    header.count = count;
+    return header;
+}
+
+bool readIndexHeader(istream& in, IndexFileHeader& header) {
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+        return false;
+    }
+    if (memcmp(header.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC)) != 0) {
+        return false;
+    }
+    if (header.version != INDEX_FILE_VERSION) {
+        cout << "⚠️  Unsupported index file version: " << header.version << "\n";
+        return false;
+    }
+    if (header.dim == 0 || header.metric > static_cast<uint32_t>(MetricType::L2) ||
+        !indexBodyFits(in, header, 0)) {
+        cout << "⚠️  Index file header does not match the file\n";
+        return false;
+    }
+    return true;
+}
+
+// a * b + c, or UINT64_MAX if that overflows
+static uint64_t checkedBytes(uint64_t a, uint64_t b, uint64_t c) {
+    if (b != 0 && a > (UINT64_MAX - c) / b) {
+        return UINT64_MAX;
+    }
+    return a * b + c;
+}
+
+bool indexBodyFits(istream& in, const IndexFileHeader& header, uint64_t rowBytes, uint64_t fixedBytes) {
+    streampos position = in.tellg();
+    if (position < 0 || !in.seekg(0, ios::end)) {
+        return false;
+    }
+    uint64_t remaining = static_cast<uint64_t>(in.tellg() - position);
+    in.seekg(position);
+
+    // Id offsets (count + 1) and id bytes follow every body
+    uint64_t idTable = checkedBytes(header.count, sizeof(uint64_t), sizeof(uint64_t));
+    uint64_t body = checkedBytes(header.count, rowBytes, fixedBytes);
+    return idTable <= remaining && body <= remaining - idTable &&
+           header.id_bytes <= remaining - idTable - body;
+}
+
+uint64_t idTableBytes(const vector<string>& ids) {
+    uint64_t total = 0;
+    for (const string& id : ids) {
+        total += id.size();
+    }
+    return total;
+}
+
+bool writeIdTable(ostream& out, const vector<string>& ids) {
+    vector<uint64_t> offsets(ids.size() + 1, 0);
+    for (size_t i = 0; i < ids.size(); ++i) {
+        offsets[i + 1] = offsets[i] + ids[i].size();
+    }
+    out.write(reinterpret_cast<const char*>(offsets.data()), offsets.size() * sizeof(uint64_t));
+    for (const string& id : ids) {
+        out.write(id.data(), id.size());
+    }
+    return static_cast<bool>(out);
+}
+
+bool readIdTable(istream& in, size_t count, uint64_t idBytes, vector<string>& ids) {
+    vector<uint64_t> offsets(count + 1);
+    if (!in.read(reinterpret_cast<char*>(offsets.data()), offsets.size() * sizeof(uint64_t))) {
+        return false;
+    }
+    if (offsets[0] != 0 || offsets[count] != idBytes) {
+        return false;
+    }
+
+    string blob(idBytes, '\0');
+    if (idBytes > 0 && !in.read(&blob[0], idBytes)) {
+        return false;
+    }
+
+    ids.clear();
+    ids.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        if (offsets[i + 1] < offsets[i]) {
+            return false;
+        }
+        ids.emplace_back(blob, offsets[i], offsets[i + 1] - offsets[i]);
+    }
+    return true;
+}
+
+bool commitIndexFile(const string& tempPath, const string& filePath) {
+    if (rename(tempPath.c_str(), filePath.c_str()) != 0) {
+        remove(tempPath.c_str());
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,86 @@
+#ifndef INDEX_FILE_H
+#define INDEX_FILE_H
+
+#include <string>
+#include <vector>
+#include <iostream>
+#include <cstdint>
+#include "../config/ConfigManager.h"
+
+using namespace std;
+
+// On-disk layout of faiss_index.bin (all fields little-endian, native packing):
+//
+//   [IndexFileHeader: 64 bytes]
+//   [index body: layout depends on index_type]
+//   [uint64 id offsets: count + 1]
+//   [id bytes: id_bytes, concatenated without separators]
+//
+// The flat body is the float32 matrix (count * dim, row-major). Every block
+// has a size computable from what precedes it, so loading is one sequential
+// read straight into the index buffers.
+
+enum class MetricType : uint32_t {
+    InnerProduct = 0,
+    L2 = 1
+};
+
+enum class IndexType : uint32_t {
+    Flat = 0,
+    IvfFlat = 1,
+    Hnsw = 2,
+    IvfPq = 3,
+    ScalarQuantized = 4,
+    Binary = 5
+};
+
+// Element encoding for flat indexes (embedding.quantization)
+enum class ScalarQuantization : uint32_t {
+    None = 0,       // float32
+    Fp16 = 1,
+    Int8 = 2        // Symmetric, one float scale per vector
+};
+
+struct IndexFileHeader {
+    char magic[8];          // "MIMIRIDX"
+    uint32_t version;
+    uint32_t index_type;    // IndexType
+    uint32_t metric;        // MetricType
+    uint32_t dim;
+    uint64_t count;
+    uint64_t id_bytes;
+    uint32_t params[6];     // Index-specific (e.g. nlist for IVF, M for HNSW), zero otherwise
+};
+
+static_assert(sizeof(IndexFileHeader) == 64, "IndexFileHeader must stay 64 bytes");
+
+constexpr uint32_t INDEX_FILE_VERSION = 1;
+
+// Metric / type helpers
+MetricType metricFromConfig(const VectorDbConfig& config);
+string metricToString(MetricType metric);
+IndexType indexTypeFromConfig(const VectorDbConfig& config);
+string indexTypeToString(IndexType type);
+ScalarQuantization quantizationFromConfig(const EmbeddingConfig& config);
+string quantizationToString(ScalarQuantization quantization);
+
+// Header helpers
+IndexFileHeader makeIndexHeader(IndexType type, MetricType metric, size_t dim, size_t count);
+// Reads the header and checks it before anything is sized from it: magic,
+// version, dim > 0, a known metric, and a file long enough for the id table
+bool readIndexHeader(istream& in, IndexFileHeader& header);
+// Whether what follows the header in the file (in positioned right after it)
+// holds a body of count * rowBytes + fixedBytes plus the id table. Loaders
+// call this before allocating; a lower bound is enough for variable layouts
+bool indexBodyFits(istream& in, const IndexFileHeader& header, uint64_t rowBytes, uint64_t fixedBytes = 0);
+
+// Id table helpers
+uint64_t idTableBytes(const vector<string>& ids);
+bool writeIdTable(ostream& out, const vector<string>& ids);
+bool readIdTable(istream& in, size_t count, uint64_t idBytes, vector<string>& ids);
+
+// Writes to a temporary file and renames it into place so a crash mid-save
+// never leaves a truncated index behind.
+bool commitIndexFile(const string& tempPath, const string& filePath);
+
+#endif // INDEX_FILE_H
@@ -0,0 +1,245 @@
+#include "IvfIndex.h"
+#include "KMeans.h"
+#include "DistanceKernels.h"
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cstdio>
+
+IvfIndex::IvfIndex(size_t dim, MetricType metric, size_t nlist, size_t nprobe)
+    : dim(dim), metric(metric), nlist(max<size_t>(nlist, 1)), nprobe(max<size_t>(nprobe, 1)) {}
+
+bool IvfIndex::add(const string& id, const float* embedding, size_t embeddingDim) {
+    if (embedding == nullptr || embeddingDim == 0) {
+        return false;
+    }
+    if (ids.empty()) {
+        // The first vector fixes the dimension; the configured dim is only a hint
+        dim = embeddingDim;
+    }
+    if (embeddingDim != dim) {
+        cout << "⚠️  Embedding for '" << id << "' has dimension " << embeddingDim
+             << ", index expects " << dim << ". Skipping.\n";
+        return false;
+    }
+
+    uint64_t row = ids.size();
+    ids.push_back(id);
+
+    if (trained) {
+        vector<float> scores(nlist);
+        assignToList(row, embedding, scores.data());
+        return true;
+    }
+
+    pending.insert(pending.end(), embedding, embedding + dim);
+    if (ids.size() >= nlist * MIN_POINTS_PER_LIST) {
+        train();
+    }
+    return true;
+}
+
+void IvfIndex::clear() {
+    trained = false;
+    centroids.clear();
+    lists.clear();
+    locations.clear();
+    pending.clear();
+    ids.clear();
+}
+
+void IvfIndex::assignToList(uint64_t row, const float* vec, float* scores) {
+    size_t list = nearestCentroid(vec, centroids.data(), nlist, dim, metric, scores);
+    InvertedList& target = lists[list];
+    locations.push_back({static_cast<uint32_t>(list), static_cast<uint32_t>(target.rows.size())});
+    target.rows.push_back(row);
+    target.vectors.insert(target.vectors.end(), vec, vec + dim);
+}
+
+bool IvfIndex::train() {
+    if (trained) {
+        return true;
+    }
+    if (ids.size() < nlist) {
+        cout << "⚠️  IVF training needs at least " << nlist << " vectors, have " << ids.size() << "\n";
+        return false;
+    }
+
+    cout << "🧮 Training IVF quantizer: " << nlist << " lists over " << ids.size() << " vectors...\n";
+    centroids = trainKMeans(pending.data(), ids.size(), dim, nlist, metric);
+
+    lists.assign(nlist, InvertedList());
+    locations.clear();
+    locations.reserve(ids.size());
+    trained = true;
+
+    vector<float> scores(nlist);
+    for (uint64_t row = 0; row < ids.size(); ++row) {
+        assignToList(row, &pending[row * dim], scores.data());
+    }
+    vector<float>().swap(pending);
+    return true;
+}
+
+bool IvfIndex::reconstruct(size_t row, float* out) const {
+    if (row >= ids.size()) {
+        return false;
+    }
+    const float* src;
+    if (trained) {
+        const RowLocation& loc = locations[row];
+        src = &lists[loc.list].vectors[size_t(loc.offset) * dim];
+    } else {
+        src = &pending[row * dim];
+    }
+    copy(src, src + dim, out);
+    return true;
+}
+
+vector<SearchResult> IvfIndex::searchVectors(const float* query, size_t k,
+                                             const SearchParams& params) const {
+    TopK heap(min(k, ids.size()));
+
+    if (!trained) {
+        scanVectors(query, pending.data(), ids.size(), dim, metric, nullptr, 0, heap);
+        return collectResults(heap, metric, *this);
+    }
+
+    // Rank the centroids, then scan only the best nprobe lists
+    size_t probes = min(params.nprobe > 0 ? params.nprobe : nprobe, nlist);
+    TopK listHeap(probes);
+    scanVectors(query, centroids.data(), nlist, dim, metric, nullptr, 0, listHeap);
+
+    for (const auto& entry : listHeap.takeSorted()) {
+        const InvertedList& list = lists[entry.second];
+        if (list.rows.empty()) continue;
+        scanVectors(query, list.vectors.data(), list.rows.size(), dim, metric,
+                    list.rows.data(), 0, heap);
+    }
+    return collectResults(heap, metric, *this);
+}
+
+string IvfIndex::describe() const {
+    stringstream ss;
+    ss << VectorIndex::describe() << ", nlist " << nlist << ", nprobe " << nprobe
+       << (trained ? "" : ", untrained");
+    return ss.str();
+}
+
+// Body layout after the common header (params[0] = nlist, params[1] = trained):
+//   trained:   centroids (nlist * dim floats), then per list:
+//              uint64 length, uint64 rows[length], float vectors[length * dim]
+//   untrained: pending matrix (count * dim floats)
+bool IvfIndex::save(const string& filePath) const {
+    string tempPath = filePath + ".tmp";
+    ofstream file(tempPath, ios::binary | ios::trunc);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    IndexFileHeader header = makeIndexHeader(IndexType::IvfFlat, metric, dim, ids.size());
+    header.id_bytes = idTableBytes(ids);
+    header.params[0] = static_cast<uint32_t>(nlist);
+    header.params[1] = trained ? 1 : 0;
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    if (trained) {
+        file.write(reinterpret_cast<const char*>(centroids.data()), centroids.size() * sizeof(float));
+        for (const InvertedList& list : lists) {
+            uint64_t length = list.rows.size();
+            file.write(reinterpret_cast<const char*>(&length), sizeof(length));
+            file.write(reinterpret_cast<const char*>(list.rows.data()), length * sizeof(uint64_t));
+            file.write(reinterpret_cast<const char*>(list.vectors.data()), list.vectors.size() * sizeof(float));
+        }
+    } else {
+        file.write(reinterpret_cast<const char*>(pending.data()), pending.size() * sizeof(float));
+    }
+    writeIdTable(file, ids);
+    file.close();
+
+    if (!file) {
+        remove(tempPath.c_str());
+        return false;
+    }
+    return commitIndexFile(tempPath, filePath);
+}
+
+bool IvfIndex::load(const string& filePath) {
+    ifstream file(filePath, ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    IndexFileHeader header;
+    if (!readIndexHeader(file, header) ||
+        header.index_type != static_cast<uint32_t>(IndexType::IvfFlat) ||
+        header.params[0] == 0) {
+        return false;
+    }
+    // Trained: centroids and list lengths, then a row number and vector per row
+    bool fits = header.params[1] != 0
+        ? indexBodyFits(file, header, sizeof(uint64_t) + uint64_t(header.dim) * sizeof(float),
+                        uint64_t(header.params[0]) * (uint64_t(header.dim) * sizeof(float) + sizeof(uint64_t)))
+        : indexBodyFits(file, header, uint64_t(header.dim) * sizeof(float));
+    if (!fits) {
+        return false;
+    }
+
+    clear();
+    dim = header.dim;
+    metric = static_cast<MetricType>(header.metric);
+    nlist = header.params[0];
+    bool loadedTrained = header.params[1] != 0;
+    size_t count = header.count;
+
+    if (loadedTrained) {
+        centroids.resize(nlist * dim);
+        if (!file.read(reinterpret_cast<char*>(centroids.data()), centroids.size() * sizeof(float))) {
+            clear();
+            return false;
+        }
+        lists.assign(nlist, InvertedList());
+        locations.assign(count, {0, 0});
+        size_t total = 0;
+        for (size_t l = 0; l < nlist; ++l) {
+            uint64_t length = 0;
+            if (!file.read(reinterpret_cast<char*>(&length), sizeof(length)) || total + length > count) {
+                clear();
+                return false;
+            }
+            InvertedList& list = lists[l];
+            list.rows.resize(length);
+            list.vectors.resize(length * dim);
+            if (!file.read(reinterpret_cast<char*>(list.rows.data()), length * sizeof(uint64_t)) ||
+                !file.read(reinterpret_cast<char*>(list.vectors.data()), list.vectors.size() * sizeof(float))) {
+                clear();
+                return false;
+            }
+            for (uint64_t offset = 0; offset < length; ++offset) {
+                if (list.rows[offset] >= count) {
+                    clear();
+                    return false;
+                }
+                locations[list.rows[offset]] = {static_cast<uint32_t>(l), static_cast<uint32_t>(offset)};
+            }
+            total += length;
+        }
+        if (total != count) {
+            clear();
+            return false;
+        }
+    } else {
+        pending.resize(count * dim);
+        if (!file.read(reinterpret_cast<char*>(pending.data()), pending.size() * sizeof(float))) {
+            clear();
+            return false;
+        }
+    }
+
+    if (!readIdTable(file, count, header.id_bytes, ids)) {
+        clear();
+        return false;
+    }
+    trained = loadedTrained;
+    return true;
+}
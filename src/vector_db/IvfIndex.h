@@ -0,0 +1,80 @@
+#ifndef IVF_INDEX_H
+#define IVF_INDEX_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "VectorIndex.h"
+
+using namespace std;
+
+// Inverted-file index (IndexIVFFlat). A k-means coarse quantizer splits the
+// vectors into `nlist` lists, each stored contiguously; a query scans only
+// the `nprobe` lists whose centroids score best.
+//
+// Until enough vectors exist to train the quantizer (MIN_POINTS_PER_LIST per
+// list), vectors are buffered and searched exactly like a flat index. Once
+// trained, new vectors go straight into their nearest list.
+class IvfIndex : public VectorIndex {
+public:
+    static const size_t MIN_POINTS_PER_LIST = 39;
+
+    IvfIndex(size_t dim, MetricType metric, size_t nlist, size_t nprobe);
+
+    using VectorIndex::add;
+    bool add(const string& id, const float* embedding, size_t embeddingDim) override;
+    void clear() override;
+
+    size_t size() const override { return ids.size(); }
+    size_t dimension() const override { return dim; }
+    MetricType getMetric() const override { return metric; }
+    IndexType getType() const override { return IndexType::IvfFlat; }
+
+    const string& idAt(size_t row) const override { return ids[row]; }
+    bool reconstruct(size_t row, float* out) const override;
+
+    // Trains the coarse quantizer on all vectors added so far and moves them
+    // into their lists. add() calls this once the training threshold is hit.
+    bool train();
+    bool isTrained() const { return trained; }
+
+    size_t getNlist() const { return nlist; }
+    size_t getNprobe() const { return nprobe; }
+    void setNprobe(size_t value) { nprobe = value; }
+
+    bool save(const string& filePath) const override;
+    bool load(const string& filePath) override;
+
+    string describe() const override;
+
+protected:
+    vector<SearchResult> searchVectors(const float* query, size_t k,
+                                       const SearchParams& params) const override;
+
+private:
+    struct InvertedList {
+        vector<float> vectors;      // Row-major, contiguous per list
+        vector<uint64_t> rows;      // Global row of each vector
+    };
+
+    struct RowLocation {
+        uint32_t list;
+        uint32_t offset;
+    };
+
+    size_t dim;
+    MetricType metric;
+    size_t nlist;
+    size_t nprobe;
+    bool trained = false;
+
+    vector<float> centroids;        // nlist x dim
+    vector<InvertedList> lists;
+    vector<RowLocation> locations;  // Row -> slot, valid once trained
+    vector<float> pending;          // Row-major buffer before training
+    vector<string> ids;
+
+    void assignToList(uint64_t row, const float* vec, float* scores);
+};
+
+#endif // IVF_INDEX_H
@@ -0,0 +1,359 @@
+#include "IvfPqIndex.h"
+#include "KMeans.h"
+#include "DistanceKernels.h"
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cstdio>
+
+IvfPqIndex::IvfPqIndex(size_t dim, MetricType metric, size_t nlist, size_t nprobe,
+                       size_t pqM, size_t rerankFactor)
+    : dim(dim), metric(metric), nlist(max<size_t>(nlist, 1)), nprobe(max<size_t>(nprobe, 1)),
+      pqM(max<size_t>(pqM, 1)), rerankFactor(rerankFactor) {}
+
+size_t IvfPqIndex::trainingThreshold() const {
+    return max(nlist, PQ_KSUB) * MIN_POINTS_PER_CENTROID;
+}
+
+bool IvfPqIndex::add(const string& id, const float* embedding, size_t embeddingDim) {
+    if (embedding == nullptr || embeddingDim == 0) {
+        return false;
+    }
+    if (ids.empty()) {
+        // The first vector fixes the dimension; the configured dim is only a hint
+        dim = embeddingDim;
+        rawVectors.setDimension(dim);
+    }
+    if (embeddingDim != dim) {
+        cout << "⚠️  Embedding for '" << id << "' has dimension " << embeddingDim
+             << ", index expects " << dim << ". Skipping.\n";
+        return false;
+    }
+
+    uint64_t row = ids.size();
+    ids.push_back(id);
+    rawVectors.append(embedding);
+
+    if (trained) {
+        vector<float> scores(nlist), residual(dim);
+        vector<uint8_t> code(pq.getM());
+        encodeToList(row, embedding, scores.data(), residual.data(), code.data());
+        return true;
+    }
+    if (ids.size() >= trainingThreshold()) {
+        train();
+    }
+    return true;
+}
+
+void IvfPqIndex::clear() {
+    trained = false;
+    centroids.clear();
+    pq = ProductQuantizer();
+    lists.clear();
+    ids.clear();
+    rawVectors.clear();
+}
+
+void IvfPqIndex::encodeToList(uint64_t row, const float* vec, float* scores, float* residual, uint8_t* code) {
+    size_t list = nearestCentroid(vec, centroids.data(), nlist, dim, metric, scores);
+    const float* centroid = &centroids[list * dim];
+    for (size_t d = 0; d < dim; ++d) residual[d] = vec[d] - centroid[d];
+    pq.encode(residual, code);
+
+    // Append into the list's last block, opening a new one when it is full
+    InvertedList& target = lists[list];
+    size_t m = pq.getM();
+    size_t slot = target.rows.size();
+    if (slot % PQ_BLOCK == 0) {
+        target.codes.resize(target.codes.size() + m * PQ_BLOCK, 0);
+    }
+    uint8_t* block = &target.codes[(slot / PQ_BLOCK) * m * PQ_BLOCK];
+    for (size_t sub = 0; sub < m; ++sub) {
+        block[sub * PQ_BLOCK + slot % PQ_BLOCK] = code[sub];
+    }
+    target.rows.push_back(row);
+}
+
+bool IvfPqIndex::train() {
+    if (trained) {
+        return true;
+    }
+    if (ids.size() < trainingThreshold()) {
+        cout << "⚠️  IVF-PQ training needs at least " << trainingThreshold() << " vectors, have " << ids.size() << "\n";
+        return false;
+    }
+
+    // Before training every vector is still in memory
+    size_t n = ids.size();
+    const float* data = rawVectors.memoryData();
+
+    cout << "🧮 Training IVF-PQ quantizers: " << nlist << " lists, " << ProductQuantizer::fitSubquantizers(dim, pqM)
+         << " sub-quantizers over " << n << " vectors...\n";
+    centroids = trainKMeans(data, n, dim, nlist, metric);
+
+    // Codebooks are fit to residuals; a strided sample is plenty since
+    // k-means subsamples to 256 points per centroid anyway
+    size_t sampleCount = min(n, PQ_KSUB * KMeansConfig().maxPointsPerCentroid);
+    size_t stride = n / sampleCount;
+    vector<float> residuals(sampleCount * dim);
+    vector<float> scores(nlist);
+    for (size_t i = 0; i < sampleCount; ++i) {
+        const float* vec = data + i * stride * dim;
+        const float* centroid = &centroids[nearestCentroid(vec, centroids.data(), nlist, dim, metric, scores.data()) * dim];
+        for (size_t d = 0; d < dim; ++d) residuals[i * dim + d] = vec[d] - centroid[d];
+    }
+    pq = ProductQuantizer(dim, pqM);
+    pq.train(residuals.data(), sampleCount);
+    vector<float>().swap(residuals);
+
+    lists.assign(nlist, InvertedList());
+    trained = true;
+
+    vector<float> residual(dim);
+    vector<uint8_t> code(pq.getM());
+    for (uint64_t row = 0; row < n; ++row) {
+        encodeToList(row, data + row * dim, scores.data(), residual.data(), code.data());
+    }
+    return true;
+}
+
+bool IvfPqIndex::reconstruct(size_t row, float* out) const {
+    return rawVectors.read(row, out);
+}
+
+vector<SearchResult> IvfPqIndex::searchVectors(const float* query, size_t k,
+                                               const SearchParams& params) const {
+    if (!trained) {
+        TopK heap(min(k, ids.size()));
+        scanVectors(query, rawVectors.memoryData(), ids.size(), dim, metric, nullptr, 0, heap);
+        return collectResults(heap, metric, *this);
+    }
+
+    const DistanceKernels& kernels = distanceKernels();
+    bool l2 = metric == MetricType::L2;
+    size_t m = pq.getM();
+
+    // Rank the centroids, then scan the codes of the best nprobe lists
+    size_t probes = min(params.nprobe > 0 ? params.nprobe : nprobe, nlist);
+    TopK listHeap(probes);
+    scanVectors(query, centroids.data(), nlist, dim, metric, nullptr, 0, listHeap);
+
+    // <q, c + r> = <q, c> + <q, r>, so one inner-product table serves every
+    // list. ||q - (c + r)||^2 = ||(q - c) - r||^2 needs a table per list.
+    vector<float> lut(m * PQ_KSUB);
+    vector<float> residual(dim);
+    if (!l2) {
+        pq.computeLookupTable(query, metric, lut.data());
+    }
+
+    size_t shortlist = rerankFactor > 0 ? k * rerankFactor : k;
+    TopK heap(min(shortlist, ids.size()));
+    vector<float> sums;
+
+    for (const auto& entry : listHeap.takeSorted()) {
+        const InvertedList& list = lists[entry.second];
+        if (list.rows.empty()) continue;
+
+        if (l2) {
+            const float* centroid = &centroids[entry.second * dim];
+            for (size_t d = 0; d < dim; ++d) residual[d] = query[d] - centroid[d];
+            pq.computeLookupTable(residual.data(), metric, lut.data());
+        }
+        float base = l2 ? 0.0f : entry.first;
+
+        size_t blocks = (list.rows.size() + PQ_BLOCK - 1) / PQ_BLOCK;
+        sums.resize(blocks * PQ_BLOCK);
+        kernels.pqLookupBlocks(lut.data(), list.codes.data(), blocks, m, sums.data());
+
+        float threshold = heap.threshold();
+        for (size_t i = 0; i < list.rows.size(); ++i) {
+            float key = l2 ? -sums[i] : base + sums[i];
+            if (key > threshold) {
+                heap.push(key, list.rows[i]);
+                threshold = heap.threshold();
+            }
+        }
+    }
+
+    if (rerankFactor == 0) {
+        return collectResults(heap, metric, *this);
+    }
+
+    // Exact re-rank of the shortlist from full-precision vectors
+    vector<pair<float, size_t>> candidates = heap.takeSorted();
+    sort(candidates.begin(), candidates.end(),
+         [](const pair<float, size_t>& a, const pair<float, size_t>& b) { return a.second < b.second; });
+    TopK exact(min(k, candidates.size()));
+    vector<float> vec(dim);
+    for (const auto& candidate : candidates) {
+        if (!rawVectors.read(candidate.second, vec.data())) continue;
+        float score = l2 ? -kernels.l2Squared(query, vec.data(), dim)
+                         : kernels.innerProduct(query, vec.data(), dim);
+        exact.push(score, candidate.second);
+    }
+    return collectResults(exact, metric, *this);
+}
+
+string IvfPqIndex::describe() const {
+    stringstream ss;
+    ss << VectorIndex::describe() << ", nlist " << nlist << ", nprobe " << nprobe;
+    if (trained) {
+        ss << ", " << pq.getM() << "-byte codes";
+    } else {
+        ss << ", untrained";
+    }
+    ss << ", rerank x" << rerankFactor;
+    return ss.str();
+}
+
+// Body layout after the common header
+// (params = nlist, trained, pq sub-quantizers):
+//   trained:   centroids (nlist * dim floats), codebooks (m * 256 * dsub floats),
+//              then per list: uint64 length, uint64 rows[length],
+//              uint8 codes[ceil(length / 16) * 16 * m]
+//   always:    full-precision matrix (count * dim floats), read lazily when trained
+bool IvfPqIndex::save(const string& filePath) const {
+    string tempPath = filePath + ".tmp";
+    ofstream file(tempPath, ios::binary | ios::trunc);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    IndexFileHeader header = makeIndexHeader(IndexType::IvfPq, metric, dim, ids.size());
+    header.id_bytes = idTableBytes(ids);
+    header.params[0] = static_cast<uint32_t>(nlist);
+    header.params[1] = trained ? 1 : 0;
+    header.params[2] = static_cast<uint32_t>(trained ? pq.getM() : pqM);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    if (trained) {
+        const vector<float>& codebooks = pq.getCodebooks();
+        file.write(reinterpret_cast<const char*>(centroids.data()), centroids.size() * sizeof(float));
+        file.write(reinterpret_cast<const char*>(codebooks.data()), codebooks.size() * sizeof(float));
+        for (const InvertedList& list : lists) {
+            uint64_t length = list.rows.size();
+            file.write(reinterpret_cast<const char*>(&length), sizeof(length));
+            file.write(reinterpret_cast<const char*>(list.rows.data()), length * sizeof(uint64_t));
+            file.write(reinterpret_cast<const char*>(list.codes.data()), list.codes.size());
+        }
+    }
+    uint64_t rawStart = static_cast<uint64_t>(file.tellp());
+    bool ok = rawVectors.write(file);
+    writeIdTable(file, ids);
+    file.close();
+
+    if (!ok || !file) {
+        remove(tempPath.c_str());
+        return false;
+    }
+    if (!commitIndexFile(tempPath, filePath)) {
+        return false;
+    }
+
+    // Once trained, the saved file becomes the backing store for full vectors
+    if (trained) {
+        rawVectors.attach(filePath, rawStart, ids.size());
+    }
+    return true;
+}
+
+bool IvfPqIndex::load(const string& filePath) {
+    ifstream file(filePath, ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    IndexFileHeader header;
+    if (!readIndexHeader(file, header) ||
+        header.index_type != static_cast<uint32_t>(IndexType::IvfPq) ||
+        header.params[0] == 0 || header.params[2] == 0) {
+        return false;
+    }
+    // Every row keeps its full vector on disk; a trained index adds centroids,
+    // list lengths, and a row number and codes per row (codebooks on top)
+    uint64_t rawRowBytes = uint64_t(header.dim) * sizeof(float);
+    bool fits = header.params[1] != 0
+        ? indexBodyFits(file, header, rawRowBytes + sizeof(uint64_t) + header.params[2],
+                        uint64_t(header.params[0]) * (rawRowBytes + sizeof(uint64_t)))
+        : indexBodyFits(file, header, rawRowBytes);
+    if (!fits) {
+        return false;
+    }
+
+    clear();
+    dim = header.dim;
+    metric = static_cast<MetricType>(header.metric);
+    nlist = header.params[0];
+    pqM = header.params[2];
+    bool loadedTrained = header.params[1] != 0;
+    size_t count = header.count;
+    size_t rawBytes = count * dim * sizeof(float);
+    rawVectors.setDimension(dim);
+
+    if (loadedTrained) {
+        pq = ProductQuantizer(dim, pqM);
+        if (pq.getM() != pqM) {
+            clear();
+            return false;
+        }
+        vector<float>& codebooks = pq.getCodebooks();
+        centroids.resize(nlist * dim);
+        codebooks.resize(pqM * PQ_KSUB * pq.getDsub());
+        if (!file.read(reinterpret_cast<char*>(centroids.data()), centroids.size() * sizeof(float)) ||
+            !file.read(reinterpret_cast<char*>(codebooks.data()), codebooks.size() * sizeof(float))) {
+            clear();
+            return false;
+        }
+
+        lists.assign(nlist, InvertedList());
+        size_t total = 0;
+        for (size_t l = 0; l < nlist; ++l) {
+            uint64_t length = 0;
+            if (!file.read(reinterpret_cast<char*>(&length), sizeof(length)) || total + length > count) {
+                clear();
+                return false;
+            }
+            InvertedList& list = lists[l];
+            list.rows.resize(length);
+            list.codes.resize((length + PQ_BLOCK - 1) / PQ_BLOCK * PQ_BLOCK * pqM);
+            if (!file.read(reinterpret_cast<char*>(list.rows.data()), length * sizeof(uint64_t)) ||
+                !file.read(reinterpret_cast<char*>(list.codes.data()), list.codes.size())) {
+                clear();
+                return false;
+            }
+            for (uint64_t row : list.rows) {
+                if (row >= count) {
+                    clear();
+                    return false;
+                }
+            }
+            total += length;
+        }
+        if (total != count) {
+            clear();
+            return false;
+        }
+    }
+
+    // Trained indexes leave the full vectors on disk
+    uint64_t rawStart = static_cast<uint64_t>(file.tellg());
+    if (loadedTrained) {
+        file.seekg(static_cast<streamoff>(rawBytes), ios::cur);
+    } else if (!rawVectors.readIntoMemory(file, count)) {
+        clear();
+        return false;
+    }
+
+    if (!readIdTable(file, count, header.id_bytes, ids)) {
+        clear();
+        return false;
+    }
+
+    if (loadedTrained && !rawVectors.attach(filePath, rawStart, count)) {
+        clear();
+        return false;
+    }
+    trained = loadedTrained;
+    return true;
+}
@@ -0,0 +1,93 @@
+#ifndef IVF_PQ_INDEX_H
+#define IVF_PQ_INDEX_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "VectorIndex.h"
+#include "ProductQuantizer.h"
+#include "RawVectorStore.h"
+
+using namespace std;
+
+// Inverted file over product-quantized residuals (IndexIVFPQ). The coarse
+// quantizer works as in IvfIndex, but each list stores only the PQ code of
+// (vector - list centroid): pq_m bytes per vector instead of 4 * dim.
+// Codes are scored against per-query ADC lookup tables.
+//
+// Full-precision vectors are not kept in memory. They are written after the
+// codes in the index file and read back with pread() for reconstruct() and
+// for the optional exact re-rank of the best k * rerankFactor candidates.
+// Vectors added since the last save stay in memory until the next save.
+//
+// Training needs MIN_POINTS_PER_CENTROID points for every coarse centroid
+// and every PQ codebook entry; until then vectors are buffered and searched
+// exactly like a flat index.
+class IvfPqIndex : public VectorIndex {
+public:
+    static const size_t MIN_POINTS_PER_CENTROID = 39;
+
+    IvfPqIndex(size_t dim, MetricType metric, size_t nlist, size_t nprobe,
+               size_t pqM, size_t rerankFactor);
+
+    using VectorIndex::add;
+    bool add(const string& id, const float* embedding, size_t embeddingDim) override;
+    void clear() override;
+
+    size_t size() const override { return ids.size(); }
+    size_t dimension() const override { return dim; }
+    MetricType getMetric() const override { return metric; }
+    IndexType getType() const override { return IndexType::IvfPq; }
+
+    const string& idAt(size_t row) const override { return ids[row]; }
+    // Reads from disk for rows saved since the index was loaded
+    bool reconstruct(size_t row, float* out) const override;
+
+    // Trains the coarse quantizer and the PQ codebooks, then encodes every
+    // buffered vector. add() calls this once the training threshold is hit.
+    bool train();
+    bool isTrained() const { return trained; }
+    size_t trainingThreshold() const;
+
+    size_t getNlist() const { return nlist; }
+    size_t getNprobe() const { return nprobe; }
+    void setNprobe(size_t value) { nprobe = value; }
+    size_t getRerankFactor() const { return rerankFactor; }
+    void setRerankFactor(size_t value) { rerankFactor = value; }
+
+    bool save(const string& filePath) const override;
+    bool load(const string& filePath) override;
+
+    string describe() const override;
+
+protected:
+    vector<SearchResult> searchVectors(const float* query, size_t k,
+                                       const SearchParams& params) const override;
+
+private:
+    struct InvertedList {
+        vector<uint8_t> codes;      // Blocks of PQ_BLOCK codes, sub-quantizer-major
+        vector<uint64_t> rows;      // Global row of each vector
+    };
+
+    size_t dim;
+    MetricType metric;
+    size_t nlist;
+    size_t nprobe;
+    size_t pqM;                     // Requested; the quantizer may use fewer
+    size_t rerankFactor;            // 0 disables the exact re-rank
+    bool trained = false;
+
+    vector<float> centroids;        // nlist x dim
+    ProductQuantizer pq;
+    vector<InvertedList> lists;
+    vector<string> ids;
+
+    // Full-precision vectors; all in memory until trained. save() moves them
+    // to disk without changing what the index holds, hence mutable.
+    mutable RawVectorStore rawVectors;
+
+    void encodeToList(uint64_t row, const float* vec, float* scores, float* residual, uint8_t* code);
+};
+
+#endif // IVF_PQ_INDEX_H
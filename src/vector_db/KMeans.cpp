@@ -0,0 +1,102 @@
+#include "KMeans.h"
+#include "DistanceKernels.h"
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <cmath>
+#include <cstring>
+
+size_t nearestCentroid(const float* vec, const float* centroids, size_t k, size_t dim,
+                       MetricType metric, float* scores) {
+    const DistanceKernels& kernels = distanceKernels();
+    if (metric == MetricType::L2) {
+        kernels.l2SquaredBatch(vec, centroids, k, dim, scores);
+        return min_element(scores, scores + k) - scores;
+    }
+    kernels.innerProductBatch(vec, centroids, k, dim, scores);
+    return max_element(scores, scores + k) - scores;
+}
+
+static void normalizeRow(float* row, size_t dim) {
+    float norm = sqrt(distanceKernels().innerProduct(row, row, dim));
+    if (norm > 0) {
+        for (size_t d = 0; d < dim; ++d) row[d] /= norm;
+    }
+}
+
+vector<float> trainKMeans(const float* data, size_t n, size_t dim, size_t k,
+                          MetricType metric, const KMeansConfig& config) {
+    vector<float> centroids(k * dim, 0.0f);
+    if (n == 0 || k == 0) {
+        return centroids;
+    }
+
+    mt19937 rng(config.seed);
+
+    // Subsample large training sets; k-means quality saturates long before
+    // every point is used
+    vector<size_t> sample(n);
+    iota(sample.begin(), sample.end(), 0);
+    size_t maxPoints = k * config.maxPointsPerCentroid;
+    if (n > maxPoints) {
+        shuffle(sample.begin(), sample.end(), rng);
+        sample.resize(maxPoints);
+        sort(sample.begin(), sample.end());  // Keep reads sequential
+    }
+    size_t m = sample.size();
+
+    // Initialize from distinct random training points (cycled if m < k)
+    vector<size_t> order(m);
+    iota(order.begin(), order.end(), 0);
+    shuffle(order.begin(), order.end(), rng);
+    for (size_t c = 0; c < k; ++c) {
+        memcpy(&centroids[c * dim], data + sample[order[c % m]] * dim, dim * sizeof(float));
+    }
+
+    vector<size_t> assignment(m, 0);
+    vector<size_t> counts(k);
+    vector<float> sums(k * dim);
+    vector<float> scores(k);
+    uniform_int_distribution<size_t> pick(0, m - 1);
+
+    for (size_t iter = 0; iter < config.iterations; ++iter) {
+        // Assignment step
+        size_t changed = 0;
+        for (size_t i = 0; i < m; ++i) {
+            size_t best = nearestCentroid(data + sample[i] * dim, centroids.data(), k, dim, metric, scores.data());
+            if (best != assignment[i] || iter == 0) {
+                changed++;
+                assignment[i] = best;
+            }
+        }
+        if (iter > 0 && changed == 0) {
+            break;
+        }
+
+        // Update step
+        fill(counts.begin(), counts.end(), 0);
+        fill(sums.begin(), sums.end(), 0.0f);
+        for (size_t i = 0; i < m; ++i) {
+            const float* vec = data + sample[i] * dim;
+            float* sum = &sums[assignment[i] * dim];
+            for (size_t d = 0; d < dim; ++d) sum[d] += vec[d];
+            counts[assignment[i]]++;
+        }
+
+        for (size_t c = 0; c < k; ++c) {
+            float* centroid = &centroids[c * dim];
+            if (counts[c] == 0) {
+                // Re-seed empty clusters from a random point so no list stays dead
+                memcpy(centroid, data + sample[pick(rng)] * dim, dim * sizeof(float));
+            } else {
+                float inv = 1.0f / counts[c];
+                for (size_t d = 0; d < dim; ++d) centroid[d] = sums[c * dim + d] * inv;
+            }
+            if (metric == MetricType::InnerProduct) {
+                normalizeRow(centroid, dim);
+            }
+        }
+    }
+
+    return centroids;
+}
@@ -0,0 +1,26 @@
+#ifndef KMEANS_H
+#define KMEANS_H
+
+#include <vector>
+#include <cstdint>
+#include "IndexFile.h"
+
+using namespace std;
+
+struct KMeansConfig {
+    size_t iterations = 20;
+    size_t maxPointsPerCentroid = 256;  // Larger training sets are subsampled
+    uint32_t seed = 1234;
+};
+
+// Lloyd's k-means over n row-major vectors; returns k x dim centroids.
+// With MetricType::InnerProduct the centroids are L2-normalized after every
+// update (spherical k-means), matching how inner-product queries are assigned.
+vector<float> trainKMeans(const float* data, size_t n, size_t dim, size_t k,
+                          MetricType metric, const KMeansConfig& config = KMeansConfig());
+
+// Index of the best centroid for one vector. `scores` must hold k floats.
+size_t nearestCentroid(const float* vec, const float* centroids, size_t k, size_t dim,
+                       MetricType metric, float* scores);
+
+#endif // KMEANS_H
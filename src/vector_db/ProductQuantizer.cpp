@@ -0,0 +1,65 @@
+#include "ProductQuantizer.h"
+#include "KMeans.h"
+#include <algorithm>
+#include <cstring>
+
+ProductQuantizer::ProductQuantizer(size_t dim, size_t m)
+    : dim(dim), m(fitSubquantizers(dim, m)), dsub(this->m > 0 ? dim / this->m : 0) {}
+
+size_t ProductQuantizer::fitSubquantizers(size_t dim, size_t requested) {
+    if (dim == 0) {
+        return 0;
+    }
+    size_t m = min(max<size_t>(requested, 1), dim);
+    while (dim % m != 0) {
+        --m;
+    }
+    return m;
+}
+
+void ProductQuantizer::train(const float* data, size_t n) {
+    codebooks.assign(m * PQ_KSUB * dsub, 0.0f);
+
+    // Sub-space centroids fit residuals, so plain L2 k-means regardless of
+    // the index metric; fewer iterations than the coarse quantizer since each
+    // sub-space is tiny
+    KMeansConfig config;
+    config.iterations = 10;
+
+    vector<float> slice(n * dsub);
+    for (size_t sub = 0; sub < m; ++sub) {
+        for (size_t i = 0; i < n; ++i) {
+            memcpy(&slice[i * dsub], data + i * dim + sub * dsub, dsub * sizeof(float));
+        }
+        config.seed = 1234 + static_cast<uint32_t>(sub);
+        vector<float> centroids = trainKMeans(slice.data(), n, dsub, PQ_KSUB, MetricType::L2, config);
+        copy(centroids.begin(), centroids.end(), codebooks.begin() + sub * PQ_KSUB * dsub);
+    }
+}
+
+void ProductQuantizer::encode(const float* vec, uint8_t* code) const {
+    float scores[PQ_KSUB];
+    for (size_t sub = 0; sub < m; ++sub) {
+        code[sub] = static_cast<uint8_t>(nearestCentroid(vec + sub * dsub, &codebooks[sub * PQ_KSUB * dsub],
+                                                         PQ_KSUB, dsub, MetricType::L2, scores));
+    }
+}
+
+void ProductQuantizer::decode(const uint8_t* code, float* out) const {
+    for (size_t sub = 0; sub < m; ++sub) {
+        const float* centroid = &codebooks[(sub * PQ_KSUB + code[sub]) * dsub];
+        copy(centroid, centroid + dsub, out + sub * dsub);
+    }
+}
+
+void ProductQuantizer::computeLookupTable(const float* query, MetricType metric, float* lut) const {
+    const DistanceKernels& kernels = distanceKernels();
+    for (size_t sub = 0; sub < m; ++sub) {
+        const float* book = &codebooks[sub * PQ_KSUB * dsub];
+        if (metric == MetricType::L2) {
+            kernels.l2SquaredBatch(query + sub * dsub, book, PQ_KSUB, dsub, lut + sub * PQ_KSUB);
+        } else {
+            kernels.innerProductBatch(query + sub * dsub, book, PQ_KSUB, dsub, lut + sub * PQ_KSUB);
+        }
+    }
+}
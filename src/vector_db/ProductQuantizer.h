@@ -0,0 +1,49 @@
+#ifndef PRODUCT_QUANTIZER_H
+#define PRODUCT_QUANTIZER_H
+
+#include <vector>
+#include <cstdint>
+#include "IndexFile.h"
+#include "DistanceKernels.h"
+
+using namespace std;
+
+// Product quantizer with 8-bit codes: a vector is split into `m` contiguous
+// sub-vectors and each is replaced by the index of its nearest centroid in
+// that sub-space's 256-entry codebook, so one vector costs `m` bytes.
+//
+// Distances use asymmetric computation (ADC): the query stays in float, one
+// lookup table of query-to-centroid partial scores is built per query, and a
+// code's score is the sum of m table entries.
+class ProductQuantizer {
+public:
+    ProductQuantizer(size_t dim = 0, size_t m = 0);
+
+    // Largest sub-quantizer count <= requested that divides dim evenly
+    static size_t fitSubquantizers(size_t dim, size_t requested);
+
+    // Trains one k-means codebook per sub-space over n row-major vectors
+    void train(const float* data, size_t n);
+    void encode(const float* vec, uint8_t* code) const;
+    void decode(const uint8_t* code, float* out) const;
+
+    // lut[sub * PQ_KSUB + c] = partial inner product (or squared L2 distance)
+    // between the query's sub-vector and centroid c of that sub-space
+    void computeLookupTable(const float* query, MetricType metric, float* lut) const;
+
+    size_t getDim() const { return dim; }
+    size_t getM() const { return m; }
+    size_t getDsub() const { return dsub; }
+
+    // m x PQ_KSUB x dsub floats, for persistence
+    vector<float>& getCodebooks() { return codebooks; }
+    const vector<float>& getCodebooks() const { return codebooks; }
+
+private:
+    size_t dim;
+    size_t m;
+    size_t dsub;
+    vector<float> codebooks;
+};
+
+#endif // PRODUCT_QUANTIZER_H
@@ -0,0 +1,83 @@
+#include "RawVectorStore.h"
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+
+RawVectorStore::~RawVectorStore() {
+    clear();
+}
+
+void RawVectorStore::clear() {
+    if (fd >= 0) {
+        close(fd);
+        fd = -1;
+    }
+    offset = 0;
+    diskRows = 0;
+    vector<float>().swap(memoryVectors);
+}
+
+void RawVectorStore::append(const float* vec) {
+    memoryVectors.insert(memoryVectors.end(), vec, vec + dim);
+}
+
+bool RawVectorStore::read(size_t row, float* out) const {
+    if (row >= size()) {
+        return false;
+    }
+    if (row >= diskRows) {
+        const float* src = &memoryVectors[(row - diskRows) * dim];
+        copy(src, src + dim, out);
+        return true;
+    }
+
+    char* dst = reinterpret_cast<char*>(out);
+    size_t remaining = dim * sizeof(float);
+    off_t position = static_cast<off_t>(offset + uint64_t(row) * dim * sizeof(float));
+    while (remaining > 0) {
+        ssize_t got = pread(fd, dst, remaining, position);
+        if (got <= 0) {
+            return false;
+        }
+        dst += got;
+        position += got;
+        remaining -= static_cast<size_t>(got);
+    }
+    return true;
+}
+
+bool RawVectorStore::write(ostream& out) const {
+    // Stream rows already on disk through a bounded buffer
+    const size_t blockRows = 256;
+    vector<float> buffer(blockRows * dim);
+    for (size_t begin = 0; begin < diskRows; begin += blockRows) {
+        size_t rows = min(blockRows, diskRows - begin);
+        for (size_t i = 0; i < rows; ++i) {
+            if (!read(begin + i, &buffer[i * dim])) {
+                return false;
+            }
+        }
+        out.write(reinterpret_cast<const char*>(buffer.data()), rows * dim * sizeof(float));
+    }
+    out.write(reinterpret_cast<const char*>(memoryVectors.data()), memoryVectors.size() * sizeof(float));
+    return static_cast<bool>(out);
+}
+
+bool RawVectorStore::readIntoMemory(istream& in, size_t rows) {
+    clear();
+    memoryVectors.resize(rows * dim);
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(memoryVectors.data()),
+                                     memoryVectors.size() * sizeof(float)));
+}
+
+bool RawVectorStore::attach(const string& filePath, uint64_t matrixOffset, size_t rows) {
+    int newFd = open(filePath.c_str(), O_RDONLY);
+    if (newFd < 0) {
+        return false;
+    }
+    clear();
+    fd = newFd;
+    offset = matrixOffset;
+    diskRows = rows;
+    return true;
+}
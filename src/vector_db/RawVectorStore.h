@@ -0,0 +1,52 @@
+#ifndef RAW_VECTOR_STORE_H
+#define RAW_VECTOR_STORE_H
+
+#include <vector>
+#include <iostream>
+#include <string>
+#include <cstdint>
+
+using namespace std;
+
+// Full-precision vectors kept out of memory for compressed indexes. Rows
+// [0, diskRows) are read with pread() from a float matrix inside a saved
+// index file; rows appended since then stay in memory until the owning
+// index is saved again and attaches the new file.
+class RawVectorStore {
+public:
+    RawVectorStore() = default;
+    ~RawVectorStore();
+
+    // Owns a file descriptor
+    RawVectorStore(const RawVectorStore&) = delete;
+    RawVectorStore& operator=(const RawVectorStore&) = delete;
+
+    void setDimension(size_t value) { dim = value; }
+    size_t size() const { return diskRows + (dim > 0 ? memoryVectors.size() / dim : 0); }
+    bool allInMemory() const { return diskRows == 0; }
+
+    void append(const float* vec);
+    bool read(size_t row, float* out) const;
+
+    // Valid only while allInMemory(): the whole row-major matrix
+    const float* memoryData() const { return memoryVectors.data(); }
+
+    // Writes every row as one row-major float matrix
+    bool write(ostream& out) const;
+    // Reads `rows` rows from the stream into memory
+    bool readIntoMemory(istream& in, size_t rows);
+    // Serves all rows from the matrix at `offset` in filePath and frees the
+    // in-memory copy; leaves the store untouched if the file cannot be opened
+    bool attach(const string& filePath, uint64_t offset, size_t rows);
+
+    void clear();
+
+private:
+    size_t dim = 0;
+    int fd = -1;
+    uint64_t offset = 0;
+    size_t diskRows = 0;
+    vector<float> memoryVectors;    // Rows [diskRows, size())
+};
+
+#endif // RAW_VECTOR_STORE_H
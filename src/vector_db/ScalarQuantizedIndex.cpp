@@ -0,0 +1,224 @@
+#include "ScalarQuantizedIndex.h"
+#include "DistanceKernels.h"
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+// Rows scored per kernel call, as in scanVectors()
+static const size_t SCAN_BLOCK_ROWS = 256;
+
+ScalarQuantizedIndex::ScalarQuantizedIndex(size_t dim, MetricType metric, ScalarQuantization quantization)
+    : dim(dim), metric(metric),
+      quantization(quantization == ScalarQuantization::Int8 ? ScalarQuantization::Int8 : ScalarQuantization::Fp16) {}
+
+float ScalarQuantizedIndex::quantizeInt8(const float* vec, size_t dim, int8_t* out) {
+    float maxAbs = 0.0f;
+    for (size_t d = 0; d < dim; ++d) maxAbs = max(maxAbs, fabs(vec[d]));
+    if (maxAbs == 0.0f) {
+        fill(out, out + dim, 0);
+        return 0.0f;
+    }
+    float scale = maxAbs / 127.0f;
+    float inv = 1.0f / scale;
+    for (size_t d = 0; d < dim; ++d) {
+        float q = nearbyint(vec[d] * inv);
+        out[d] = static_cast<int8_t>(min(127.0f, max(-127.0f, q)));
+    }
+    return scale;
+}
+
+bool ScalarQuantizedIndex::add(const string& id, const float* embedding, size_t embeddingDim) {
+    if (embedding == nullptr || embeddingDim == 0) {
+        return false;
+    }
+    if (ids.empty()) {
+        // The first vector fixes the dimension; the configured dim is only a hint
+        dim = embeddingDim;
+    }
+    if (embeddingDim != dim) {
+        cout << "⚠️  Embedding for '" << id << "' has dimension " << embeddingDim
+             << ", index expects " << dim << ". Skipping.\n";
+        return false;
+    }
+
+    if (quantization == ScalarQuantization::Int8) {
+        size_t offset = int8Rows.size();
+        int8Rows.resize(offset + dim);
+        float scale = quantizeInt8(embedding, dim, &int8Rows[offset]);
+        int32_t codeNorm = 0;
+        for (size_t d = 0; d < dim; ++d) codeNorm += int32_t(int8Rows[offset + d]) * int8Rows[offset + d];
+        scales.push_back(scale);
+        squaredNorms.push_back(scale * scale * codeNorm);
+    } else {
+        for (size_t d = 0; d < dim; ++d) halfRows.push_back(floatToHalf(embedding[d]));
+    }
+    ids.push_back(id);
+    return true;
+}
+
+void ScalarQuantizedIndex::clear() {
+    halfRows.clear();
+    int8Rows.clear();
+    scales.clear();
+    squaredNorms.clear();
+    ids.clear();
+}
+
+void ScalarQuantizedIndex::computeSquaredNorms() {
+    squaredNorms.resize(ids.size());
+    for (size_t row = 0; row < ids.size(); ++row) {
+        const int8_t* code = &int8Rows[row * dim];
+        int32_t codeNorm = 0;
+        for (size_t d = 0; d < dim; ++d) codeNorm += int32_t(code[d]) * code[d];
+        squaredNorms[row] = scales[row] * scales[row] * codeNorm;
+    }
+}
+
+bool ScalarQuantizedIndex::reconstruct(size_t row, float* out) const {
+    if (row >= ids.size()) {
+        return false;
+    }
+    if (quantization == ScalarQuantization::Int8) {
+        const int8_t* code = &int8Rows[row * dim];
+        for (size_t d = 0; d < dim; ++d) out[d] = code[d] * scales[row];
+    } else {
+        const uint16_t* code = &halfRows[row * dim];
+        for (size_t d = 0; d < dim; ++d) out[d] = halfToFloat(code[d]);
+    }
+    return true;
+}
+
+vector<SearchResult> ScalarQuantizedIndex::searchVectors(const float* query, size_t k,
+                                                         const SearchParams& params) const {
+    (void)params;
+    const DistanceKernels& kernels = distanceKernels();
+    bool l2 = metric == MetricType::L2;
+    size_t count = ids.size();
+    TopK heap(min(k, count));
+    float scores[SCAN_BLOCK_ROWS];
+
+    // int8: <q, r> ~= qScale * rScale * <q8, r8>, and L2 expands to
+    // ||q||^2 + ||r||^2 - 2 <q, r> with the exact float ||q||^2
+    vector<int8_t> queryCode;
+    float queryScale = 0.0f;
+    float queryNorm = 0.0f;
+    int32_t dots[SCAN_BLOCK_ROWS];
+    if (quantization == ScalarQuantization::Int8) {
+        queryCode.resize(dim);
+        queryScale = quantizeInt8(query, dim, queryCode.data());
+        queryNorm = kernels.innerProduct(query, query, dim);
+    }
+
+    for (size_t begin = 0; begin < count; begin += SCAN_BLOCK_ROWS) {
+        size_t blockRows = min(SCAN_BLOCK_ROWS, count - begin);
+        if (quantization == ScalarQuantization::Int8) {
+            kernels.int8DotBatch(queryCode.data(), &int8Rows[begin * dim], blockRows, dim, dots);
+            for (size_t i = 0; i < blockRows; ++i) {
+                float ip = queryScale * scales[begin + i] * dots[i];
+                scores[i] = l2 ? 2.0f * ip - queryNorm - squaredNorms[begin + i] : ip;
+            }
+        } else if (l2) {
+            kernels.fp16L2SquaredBatch(query, &halfRows[begin * dim], blockRows, dim, scores);
+            for (size_t i = 0; i < blockRows; ++i) scores[i] = -scores[i];
+        } else {
+            kernels.fp16InnerProductBatch(query, &halfRows[begin * dim], blockRows, dim, scores);
+        }
+
+        float threshold = heap.threshold();
+        for (size_t i = 0; i < blockRows; ++i) {
+            if (scores[i] > threshold) {
+                heap.push(scores[i], begin + i);
+                threshold = heap.threshold();
+            }
+        }
+    }
+    return collectResults(heap, metric, *this);
+}
+
+string ScalarQuantizedIndex::describe() const {
+    stringstream ss;
+    ss << VectorIndex::describe() << ", " << quantizationToString(quantization);
+    return ss.str();
+}
+
+// Body layout after the common header (params[0] = ScalarQuantization):
+//   fp16: uint16 rows[count * dim]
+//   int8: int8 rows[count * dim], float scales[count]
+bool ScalarQuantizedIndex::save(const string& filePath) const {
+    string tempPath = filePath + ".tmp";
+    ofstream file(tempPath, ios::binary | ios::trunc);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    IndexFileHeader header = makeIndexHeader(IndexType::ScalarQuantized, metric, dim, ids.size());
+    header.id_bytes = idTableBytes(ids);
+    header.params[0] = static_cast<uint32_t>(quantization);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    if (quantization == ScalarQuantization::Int8) {
+        file.write(reinterpret_cast<const char*>(int8Rows.data()), int8Rows.size());
+        file.write(reinterpret_cast<const char*>(scales.data()), scales.size() * sizeof(float));
+    } else {
+        file.write(reinterpret_cast<const char*>(halfRows.data()), halfRows.size() * sizeof(uint16_t));
+    }
+    writeIdTable(file, ids);
+    file.close();
+
+    if (!file) {
+        remove(tempPath.c_str());
+        return false;
+    }
+    return commitIndexFile(tempPath, filePath);
+}
+
+bool ScalarQuantizedIndex::load(const string& filePath) {
+    ifstream file(filePath, ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    IndexFileHeader header;
+    if (!readIndexHeader(file, header) ||
+        header.index_type != static_cast<uint32_t>(IndexType::ScalarQuantized)) {
+        return false;
+    }
+    ScalarQuantization loadedQuantization = static_cast<ScalarQuantization>(header.params[0]);
+    if (loadedQuantization != ScalarQuantization::Fp16 && loadedQuantization != ScalarQuantization::Int8) {
+        return false;
+    }
+    uint64_t rowBytes = loadedQuantization == ScalarQuantization::Int8
+        ? uint64_t(header.dim) + sizeof(float)         // int8 codes and a scale
+        : uint64_t(header.dim) * sizeof(uint16_t);
+    if (!indexBodyFits(file, header, rowBytes)) {
+        return false;
+    }
+
+    clear();
+    dim = header.dim;
+    metric = static_cast<MetricType>(header.metric);
+    quantization = loadedQuantization;
+    size_t count = header.count;
+
+    bool ok;
+    if (quantization == ScalarQuantization::Int8) {
+        int8Rows.resize(count * dim);
+        scales.resize(count);
+        ok = file.read(reinterpret_cast<char*>(int8Rows.data()), int8Rows.size()) &&
+             file.read(reinterpret_cast<char*>(scales.data()), scales.size() * sizeof(float));
+    } else {
+        halfRows.resize(count * dim);
+        ok = static_cast<bool>(file.read(reinterpret_cast<char*>(halfRows.data()), halfRows.size() * sizeof(uint16_t)));
+    }
+
+    if (!ok || !readIdTable(file, count, header.id_bytes, ids)) {
+        clear();
+        return false;
+    }
+    if (quantization == ScalarQuantization::Int8) {
+        computeSquaredNorms();
+    }
+    return true;
+}
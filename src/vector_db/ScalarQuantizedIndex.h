@@ -0,0 +1,64 @@
+#ifndef SCALAR_QUANTIZED_INDEX_H
+#define SCALAR_QUANTIZED_INDEX_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "VectorIndex.h"
+
+using namespace std;
+
+// Exact-scan index over scalar-quantized rows (IndexScalarQuantizer), chosen
+// for flat index types by embedding.quantization:
+//
+//   fp16: IEEE half per element (2 bytes), widened with F16C while scanning
+//   int8: symmetric int8 per element (1 byte) plus one float scale per row.
+//         The query is quantized the same way and rows are scored with
+//         integer dot products (AVX-512 VNNI where available).
+//
+// Needs no training, so rows can be appended one at a time like FlatIndex.
+class ScalarQuantizedIndex : public VectorIndex {
+public:
+    ScalarQuantizedIndex(size_t dim, MetricType metric, ScalarQuantization quantization);
+
+    using VectorIndex::add;
+    bool add(const string& id, const float* embedding, size_t embeddingDim) override;
+    void clear() override;
+
+    size_t size() const override { return ids.size(); }
+    size_t dimension() const override { return dim; }
+    MetricType getMetric() const override { return metric; }
+    IndexType getType() const override { return IndexType::ScalarQuantized; }
+
+    const string& idAt(size_t row) const override { return ids[row]; }
+    // Only the quantized copy is kept; reconstruct() returns an approximation
+    bool reconstruct(size_t row, float* out) const override;
+
+    ScalarQuantization getQuantization() const { return quantization; }
+
+    bool save(const string& filePath) const override;
+    bool load(const string& filePath) override;
+
+    string describe() const override;
+
+protected:
+    vector<SearchResult> searchVectors(const float* query, size_t k,
+                                       const SearchParams& params) const override;
+
+private:
+    size_t dim;
+    MetricType metric;
+    ScalarQuantization quantization;
+
+    vector<uint16_t> halfRows;      // fp16: count x dim
+    vector<int8_t> int8Rows;        // int8: count x dim
+    vector<float> scales;           // int8: dequantization scale per row
+    vector<float> squaredNorms;     // int8: ||dequantized row||^2, for L2
+    vector<string> ids;
+
+    // Symmetric quantization to [-127, 127]; returns the scale
+    static float quantizeInt8(const float* vec, size_t dim, int8_t* out);
+    void computeSquaredNorms();
+};
+
+#endif // SCALAR_QUANTIZED_INDEX_H
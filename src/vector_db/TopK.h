@@ -0,0 +1,57 @@
+#ifndef TOP_K_H
+#define TOP_K_H
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <utility>
+
+using namespace std;
+
+struct SearchResult {
+    string id;
+    size_t row;     // Row in the index that produced the hit
+    float score;    // Inner product (higher is better) or squared L2 (lower is better)
+};
+
+// Bounded min-heap keeping the k largest keys seen so far. The root is the
+// weakest survivor, so rejecting a candidate is a single compare.
+class TopK {
+public:
+    explicit TopK(size_t k) : k(k) { heap.reserve(k); }
+
+    void push(float key, size_t row) {
+        if (k == 0) return;
+        if (heap.size() < k) {
+            heap.emplace_back(key, row);
+            push_heap(heap.begin(), heap.end(), greater<pair<float, size_t>>());
+        } else if (key > heap.front().first) {
+            pop_heap(heap.begin(), heap.end(), greater<pair<float, size_t>>());
+            heap.back() = make_pair(key, row);
+            push_heap(heap.begin(), heap.end(), greater<pair<float, size_t>>());
+        }
+    }
+
+    // Smallest key that can still enter the heap
+    float threshold() const {
+        return heap.size() < k ? -numeric_limits<float>::infinity() : heap.front().first;
+    }
+
+    size_t size() const { return heap.size(); }
+
+    // Best first; leaves the heap empty
+    vector<pair<float, size_t>> takeSorted() {
+        sort(heap.begin(), heap.end(), greater<pair<float, size_t>>());
+        vector<pair<float, size_t>> sorted;
+        sorted.swap(heap);
+        return sorted;
+    }
+
+private:
+    size_t k;
+    vector<pair<float, size_t>> heap;
+};
+
+#endif // TOP_K_H
@@ -0,0 +1,158 @@
+#include "VectorIndex.h"
+#include "DistanceKernels.h"
+#include "FlatIndex.h"
+#include "IvfIndex.h"
+#include "HnswIndex.h"
+#include "IvfPqIndex.h"
+#include "ScalarQuantizedIndex.h"
+#include "BinaryIndex.h"
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+
+vector<SearchResult> VectorIndex::search(const vector<float>& query, size_t k,
+                                         const SearchParams& params) const {
+    if (k == 0 || size() == 0) {
+        return {};
+    }
+    if (query.size() != dimension()) {
+        cout << "⚠️  Query has dimension " << query.size() << ", index expects " << dimension() << "\n";
+        return {};
+    }
+    return searchVectors(query.data(), k, params);
+}
+
+string VectorIndex::describe() const {
+    stringstream ss;
+    ss << indexTypeToString(getType()) << " (" << metricToString(getMetric())
+       << ", dim " << dimension() << ", " << size() << " vectors)";
+    return ss.str();
+}
+
+shared_ptr<VectorIndex> createIndex(const VectorDbConfig& config, const EmbeddingConfig& embedding) {
+    size_t dim = embedding.dim > 0 ? embedding.dim : 0;
+    MetricType metric = metricFromConfig(config);
+    switch (indexTypeFromConfig(config)) {
+        case IndexType::IvfFlat:
+            return make_shared<IvfIndex>(dim, metric, config.nlist, config.nprobe);
+        case IndexType::Hnsw:
+            return make_shared<HnswIndex>(dim, metric, config.hnsw_m, config.hnsw_ef_construction,
+                                          config.hnsw_ef_search);
+        case IndexType::IvfPq:
+            return make_shared<IvfPqIndex>(dim, metric, config.nlist, config.nprobe, config.pq_m,
+                                           config.pq_rerank_factor);
+        case IndexType::Binary:
+            return make_shared<BinaryIndex>(dim, metric, config.binary_candidates);
+        case IndexType::ScalarQuantized:
+        case IndexType::Flat:
+            break;
+    }
+    ScalarQuantization quantization = quantizationFromConfig(embedding);
+    if (quantization != ScalarQuantization::None) {
+        return make_shared<ScalarQuantizedIndex>(dim, metric, quantization);
+    }
+    auto flat = make_shared<FlatIndex>(dim, metric);
+    flat->setPrefixSearch(max(config.prefix_dim, 0), max(config.prefix_shortlist, 0));
+    return flat;
+}
+
+shared_ptr<VectorIndex> loadIndexFile(const string& filePath, const VectorDbConfig& config,
+                                      const SessionConfig& session) {
+    IndexFileHeader header;
+    {
+        ifstream file(filePath, ios::binary);
+        if (!file.is_open() || !readIndexHeader(file, header)) {
+            return nullptr;
+        }
+    }
+
+    shared_ptr<VectorIndex> index;
+    MetricType metric = static_cast<MetricType>(header.metric);
+    switch (static_cast<IndexType>(header.index_type)) {
+        case IndexType::Flat: {
+            // The prefix matrix is derived from the rows, so it follows the config
+            auto flat = make_shared<FlatIndex>(header.dim, metric);
+            flat->setPrefixSearch(max(config.prefix_dim, 0), max(config.prefix_shortlist, 0));
+            flat->setMapping(session.mmap_embeddings, session.mmap_populate,
+                             mapAdviceFromString(session.mmap_advice));
+            index = flat;
+            break;
+        }
+        case IndexType::IvfFlat:
+            index = make_shared<IvfIndex>(header.dim, metric, header.params[0], config.nprobe);
+            break;
+        case IndexType::Hnsw:
+            // Graph parameters come from the file; only efSearch follows the config
+            index = make_shared<HnswIndex>(header.dim, metric, header.params[0], header.params[1],
+                                           config.hnsw_ef_search);
+            break;
+        case IndexType::ScalarQuantized:
+            index = make_shared<ScalarQuantizedIndex>(header.dim, metric,
+                                                      static_cast<ScalarQuantization>(header.params[0]));
+            break;
+        case IndexType::IvfPq:
+            index = make_shared<IvfPqIndex>(header.dim, metric, header.params[0], config.nprobe,
+                                            header.params[2], config.pq_rerank_factor);
+            break;
+        case IndexType::Binary:
+            index = make_shared<BinaryIndex>(header.dim, metric, config.binary_candidates);
+            break;
+        default:
+            cout << "⚠️  Unknown index type " << header.index_type << " in " << filePath << "\n";
+            return nullptr;
+    }
+
+    if (!index->load(filePath)) {
+        return nullptr;
+    }
+    return index;
+}
+
+// Rows scored per kernel call: 256 rows of 256-dim floats is 256 KB, which
+// stays in L2 while the heap pass runs over the score buffer
+static const size_t SCAN_BLOCK_ROWS = 256;
+
+void scanVectors(const float* query, const float* vectors, size_t count, size_t dim,
+                 MetricType metric, const uint64_t* rowIds, size_t firstRow, TopK& heap,
+                 size_t stride) {
+    const DistanceKernels& kernels = distanceKernels();
+    bool l2 = metric == MetricType::L2;
+    float scores[SCAN_BLOCK_ROWS];
+    if (stride == 0) {
+        stride = dim;
+    }
+
+    for (size_t begin = 0; begin < count; begin += SCAN_BLOCK_ROWS) {
+        size_t blockRows = min(SCAN_BLOCK_ROWS, count - begin);
+        const float* block = vectors + begin * stride;
+        if (stride != dim) {
+            // Padded rows: the batch kernels expect them packed
+            for (size_t i = 0; i < blockRows; ++i) {
+                const float* row = block + i * stride;
+                scores[i] = l2 ? -kernels.l2Squared(query, row, dim) : kernels.innerProduct(query, row, dim);
+            }
+        } else if (l2) {
+            kernels.l2SquaredBatch(query, block, blockRows, dim, scores);
+            for (size_t i = 0; i < blockRows; ++i) scores[i] = -scores[i];
+        } else {
+            kernels.innerProductBatch(query, block, blockRows, dim, scores);
+        }
+
+        float threshold = heap.threshold();
+        for (size_t i = 0; i < blockRows; ++i) {
+            if (scores[i] > threshold) {
+                heap.push(scores[i], rowIds ? rowIds[begin + i] : firstRow + begin + i);
+                threshold = heap.threshold();
+            }
+        }
+    }
+}
+
+vector<SearchResult> collectResults(TopK& heap, MetricType metric, const VectorIndex& index) {
+    vector<SearchResult> results;
+    bool l2 = metric == MetricType::L2;
+    for (const auto& entry : heap.takeSorted()) {
+        results.push_back({index.idAt(entry.second), entry.second, l2 ? -entry.first : entry.first});
+    }
+    return results;
+}
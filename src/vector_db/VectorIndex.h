@@ -0,0 +1,80 @@
+#ifndef VECTOR_INDEX_H
+#define VECTOR_INDEX_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include "IndexFile.h"
+#include "TopK.h"
+
+using namespace std;
+
+// Per-query knobs; zero means "use the index's configured default"
+struct SearchParams {
+    size_t nprobe = 0;      // IVF: inverted lists visited per query
+    size_t efSearch = 0;    // HNSW: candidate list width on level 0
+};
+
+// Common interface for the session's vector indexes. Rows are numbered in
+// insertion order regardless of how an index lays vectors out internally.
+class VectorIndex {
+public:
+    virtual ~VectorIndex() = default;
+
+    // Append one vector of embeddingDim floats, copied straight from the
+    // caller's buffer (e.g. a row of a decoded batch); the first vector
+    // added fixes the dimension
+    virtual bool add(const string& id, const float* embedding, size_t embeddingDim) = 0;
+    bool add(const string& id, const vector<float>& embedding) {
+        return add(id, embedding.data(), embedding.size());
+    }
+    virtual void clear() = 0;
+
+    virtual size_t size() const = 0;
+    virtual size_t dimension() const = 0;
+    virtual MetricType getMetric() const = 0;
+    virtual IndexType getType() const = 0;
+
+    virtual const string& idAt(size_t row) const = 0;
+    // Copies the stored vector for `row` into out[0..dimension())
+    virtual bool reconstruct(size_t row, float* out) const = 0;
+
+    // Top-k search, best first. Checks the query dimension, then dispatches
+    // to the index-specific searchVectors().
+    vector<SearchResult> search(const vector<float>& query, size_t k,
+                                const SearchParams& params = SearchParams()) const;
+
+    // Persistence (see IndexFile.h for the shared header and id table)
+    virtual bool save(const string& filePath) const = 0;
+    virtual bool load(const string& filePath) = 0;
+
+    virtual string describe() const;
+
+protected:
+    virtual vector<SearchResult> searchVectors(const float* query, size_t k,
+                                               const SearchParams& params) const = 0;
+};
+
+// Factory: an empty index of the type named by vector_db.faiss.index_type.
+// Flat types honor embedding.quantization; embedding.dim is only a hint.
+shared_ptr<VectorIndex> createIndex(const VectorDbConfig& config, const EmbeddingConfig& embedding);
+
+// Opens an index file of any type; returns nullptr if it is missing or
+// invalid. A flat index maps its rows as session.mmap_* says.
+shared_ptr<VectorIndex> loadIndexFile(const string& filePath, const VectorDbConfig& config,
+                                      const SessionConfig& session);
+
+// Shared scan helpers for index implementations
+
+// Scores `count` vectors, `stride` floats apart (0: packed, stride = dim),
+// against the query and offers them to the heap. The row of vector i is
+// rowIds[i] when given, otherwise firstRow + i. L2 distances are negated so
+// the heap always keeps the largest keys.
+void scanVectors(const float* query, const float* vectors, size_t count, size_t dim,
+                 MetricType metric, const uint64_t* rowIds, size_t firstRow, TopK& heap,
+                 size_t stride = 0);
+
+// Drains the heap into best-first results, restoring L2 distances
+vector<SearchResult> collectResults(TopK& heap, MetricType metric, const VectorIndex& index);
+
+#endif // VECTOR_INDEX_H